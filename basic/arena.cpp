@@ -0,0 +1,70 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+thread_local Arena* current_arena = nullptr;
+
+}  // namespace
+
+Arena::Arena(size_t chunk_size) : chunk_size_(chunk_size) {
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    auto aligned = [&] {
+        auto address = reinterpret_cast<uintptr_t>(pos_);
+        return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+    };
+    std::byte* result = aligned();
+    if (!pos_ || result + size > end_) {
+        AddChunk(size + alignment);
+        result = aligned();
+    }
+    pos_ = result + size;
+    used_ += size;
+    return result;
+}
+
+void Arena::Reset() {
+    if (chunks_.size() > 1) {
+        chunks_.erase(chunks_.begin() + 1, chunks_.end());
+    }
+    if (!chunks_.empty()) {
+        pos_ = chunks_.front().data.get();
+        end_ = pos_ + chunks_.front().size;
+    }
+    used_ = 0;
+}
+
+size_t Arena::BytesUsed() const {
+    return used_;
+}
+
+size_t Arena::ChunkCount() const {
+    return chunks_.size();
+}
+
+Arena* Arena::Current() {
+    return current_arena;
+}
+
+void Arena::AddChunk(size_t min_size) {
+    size_t size = std::max(chunk_size_, min_size);
+    // Plain new[]: the memory is handed out uninitialized anyway.
+    chunks_.push_back(Chunk{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    pos_ = chunks_.back().data.get();
+    end_ = pos_ + size;
+}
+
+ArenaScope::ArenaScope(Arena* arena) : arena_(arena), previous_(current_arena) {
+    current_arena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+    current_arena = previous_;
+    if (arena_) {
+        arena_->Reset();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for objects that all die together. Allocation is a pointer increment;
+// individual frees are no-ops and Reset() releases everything at once.
+class Arena {
+public:
+    explicit Arena(size_t chunk_size = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment);
+
+    // Forgets every allocation. The first chunk is kept for the next round, the rest is freed.
+    void Reset();
+
+    // Bytes handed out since the last Reset().
+    size_t BytesUsed() const;
+
+    size_t ChunkCount() const;
+
+    // Arena that MakeObject() allocates from on this thread, or nullptr for the regular heap.
+    static Arena* Current();
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    void AddChunk(size_t min_size);
+
+    size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    std::byte* pos_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t used_ = 0;
+};
+
+// Makes `arena` the current arena of this thread for the scope's lifetime and resets it on
+// exit. Every object allocated in the scope must be gone by then. A null arena switches the
+// thread back to the heap for the scope.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena* arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* arena_;
+    Arena* previous_;
+};
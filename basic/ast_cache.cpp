@@ -0,0 +1,338 @@
+#include "ast_cache.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "loader.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'C', 'M', 'A', 'S', 'T', '0', '1'};
+constexpr size_t kHeaderSize = sizeof(kMagic) + 8 + 4 + 4;
+
+enum class NodeTag : uint8_t { NIL, NUMBER, SYMBOL, CELL };
+
+void PutFixed(std::string* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out->push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void PutVarint(std::string* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+// Bounds-checked cursor over the encoded bytes; every getter fails instead of reading past the
+// end.
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data)
+        : pos_(data.data()), end_(data.data() + data.size()) {
+    }
+
+    bool AtEnd() const {
+        return pos_ == end_;
+    }
+
+    size_t Remaining() const {
+        return end_ - pos_;
+    }
+
+    bool Fixed(size_t bytes, uint64_t* value) {
+        if (Remaining() < bytes) {
+            return false;
+        }
+        *value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            *value |= static_cast<uint64_t>(static_cast<uint8_t>(pos_[i])) << (8 * i);
+        }
+        pos_ += bytes;
+        return true;
+    }
+
+    bool Varint(uint64_t* value) {
+        *value = 0;
+        for (int shift = 0; shift < 64 && pos_ != end_; shift += 7) {
+            uint8_t byte = *pos_++;
+            *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Bytes(size_t size, std::string_view* bytes) {
+        if (Remaining() < size) {
+            return false;
+        }
+        *bytes = std::string_view(pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+// Read-only mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            size_ = info.st_size;
+            if (size_ == 0) {
+                open_ = true;
+            } else {
+                data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                open_ = data_ != MAP_FAILED;
+                if (!open_) {
+                    data_ = nullptr;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const {
+        return open_;
+    }
+
+    std::string_view Data() const {
+        return data_ ? std::string_view(static_cast<const char*>(data_), size_) : "";
+    }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+};
+
+const ParseError kCorrupt{"corrupt AST cache"};
+
+}  // namespace
+
+uint64_t HashSource(std::string_view source) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : source) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string EncodeForms(const std::vector<Ref<Object>>& forms, uint64_t source_hash) {
+    std::unordered_map<std::string_view, uint32_t> symbol_index;
+    std::vector<std::string_view> symbols;
+    std::string nodes;
+    std::vector<const Object*> pending;
+    for (const auto& form : forms) {
+        pending.push_back(form.get());
+        while (!pending.empty()) {
+            const Object* object = pending.back();
+            pending.pop_back();
+            if (!object) {
+                nodes.push_back(static_cast<char>(NodeTag::NIL));
+            } else if (auto number = As<Number>(object)) {
+                uint64_t value = number->GetValue();
+                nodes.push_back(static_cast<char>(NodeTag::NUMBER));
+                PutVarint(&nodes, (value << 1) ^ -(value >> 63));
+            } else if (auto symbol = As<Symbol>(object)) {
+                auto [it, inserted] = symbol_index.emplace(symbol->GetName(), symbols.size());
+                if (inserted) {
+                    symbols.push_back(symbol->GetName());
+                }
+                nodes.push_back(static_cast<char>(NodeTag::SYMBOL));
+                PutVarint(&nodes, it->second);
+            } else if (auto cell = As<Cell>(object)) {
+                nodes.push_back(static_cast<char>(NodeTag::CELL));
+                pending.push_back(cell->GetSecond().get());
+                pending.push_back(cell->GetFirst().get());
+            } else {
+                throw RuntimeError{"cannot encode a builtin"};
+            }
+        }
+    }
+
+    std::string out(kMagic, sizeof(kMagic));
+    PutFixed(&out, source_hash, 8);
+    PutFixed(&out, symbols.size(), 4);
+    PutFixed(&out, forms.size(), 4);
+    for (auto name : symbols) {
+        PutVarint(&out, name.size());
+        out += name;
+    }
+    return out + nodes;
+}
+
+Expected<std::vector<Ref<Object>>> DecodeForms(std::string_view data, uint64_t source_hash) {
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        return ParseError{"not an AST cache"};
+    }
+    ByteReader reader{data.substr(sizeof(kMagic))};
+    uint64_t hash = 0, symbol_count = 0, form_count = 0;
+    reader.Fixed(8, &hash);
+    reader.Fixed(4, &symbol_count);
+    reader.Fixed(4, &form_count);
+    if (hash != source_hash) {
+        return ParseError{"AST cache is stale"};
+    }
+    // Every symbol and form takes at least one byte, which bounds the reservations below.
+    if (symbol_count + form_count > reader.Remaining()) {
+        return kCorrupt;
+    }
+
+    std::vector<Ref<Object>> symbols;
+    symbols.reserve(symbol_count);
+    for (uint64_t i = 0; i < symbol_count; ++i) {
+        uint64_t size;
+        std::string_view name;
+        if (!reader.Varint(&size) || !reader.Bytes(size, &name)) {
+            return kCorrupt;
+        }
+        symbols.push_back(SymbolObject(name));
+    }
+
+    struct Pending {
+        Cell* parent;
+        bool is_first;
+    };
+    std::vector<Ref<Object>> forms(form_count);
+    std::vector<Pending> pending;
+    for (auto& form : forms) {
+        pending.push_back({nullptr, false});
+        while (!pending.empty()) {
+            auto [parent, is_first] = pending.back();
+            pending.pop_back();
+            uint64_t tag, value;
+            if (!reader.Fixed(1, &tag)) {
+                return kCorrupt;
+            }
+            Ref<Object> node;
+            switch (static_cast<NodeTag>(tag)) {
+                case NodeTag::NIL:
+                    break;
+                case NodeTag::NUMBER:
+                    if (!reader.Varint(&value)) {
+                        return kCorrupt;
+                    }
+                    node = NumberObject(static_cast<int64_t>((value >> 1) ^ -(value & 1)));
+                    break;
+                case NodeTag::SYMBOL:
+                    if (!reader.Varint(&value) || value >= symbols.size()) {
+                        return kCorrupt;
+                    }
+                    node = symbols[value];
+                    break;
+                case NodeTag::CELL: {
+                    auto cell = MakeObject<Cell>();
+                    pending.push_back({cell.get(), false});
+                    pending.push_back({cell.get(), true});
+                    node = std::move(cell);
+                    break;
+                }
+                default:
+                    return kCorrupt;
+            }
+            if (!parent) {
+                form = std::move(node);
+            } else if (is_first) {
+                parent->AppendFirst(std::move(node));
+            } else {
+                parent->AppendSecond(std::move(node));
+            }
+        }
+    }
+    if (!reader.AtEnd()) {
+        return kCorrupt;
+    }
+    return forms;
+}
+
+void WriteAstFile(const std::string& path, const std::vector<Ref<Object>>& forms,
+                  uint64_t source_hash) {
+    std::string data = EncodeForms(forms, source_hash);
+    // Unique per call, so that writers in other threads and processes never share the file;
+    // the last rename wins and readers only ever see complete caches.
+    static std::atomic<uint64_t> writes{0};
+    std::string temp_path = path + ".tmp." + std::to_string(getpid()) + "." +
+                            std::to_string(writes.fetch_add(1, std::memory_order_relaxed));
+    int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        throw RuntimeError{"cannot write " + temp_path};
+    }
+    std::string_view rest = data;
+    while (!rest.empty()) {
+        ssize_t written = write(fd, rest.data(), rest.size());
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            close(fd);
+            std::remove(temp_path.c_str());
+            throw RuntimeError{"cannot write " + temp_path};
+        }
+        rest.remove_prefix(written);
+    }
+    if (close(fd) != 0) {
+        std::remove(temp_path.c_str());
+        throw RuntimeError{"cannot write " + temp_path};
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw RuntimeError{"cannot write " + path};
+    }
+}
+
+Expected<std::vector<Ref<Object>>> LoadAstFile(const std::string& path, uint64_t source_hash) {
+    MappedFile file{path};
+    if (!file.IsOpen()) {
+        return ParseError{"cannot read " + path};
+    }
+    return DecodeForms(file.Data(), source_hash);
+}
+
+std::vector<Ref<Object>> LoadSourceFile(const std::string& path, ThreadPool* pool) {
+    MappedFile source{path};
+    if (!source.IsOpen()) {
+        throw RuntimeError{"cannot read " + path};
+    }
+    uint64_t hash = HashSource(source.Data());
+    std::string cache_path = path + ".ast";
+    if (auto cached = LoadAstFile(cache_path, hash)) {
+        return std::move(cached.Value());
+    }
+    auto forms = ReadAll(source.Data(), pool);
+    try {
+        WriteAstFile(cache_path, forms, hash);
+    } catch (const RuntimeError&) {
+        // Read-only deployments still work, they just parse every time.
+    }
+    return forms;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "thread_pool.h"
+
+// Binary encoding of the forms read from a source file, so that an unchanged file can be loaded
+// without tokenizing and parsing it again.
+//
+// Layout, integers little-endian:
+//     magic "SCMAST01" | u64 source hash | u32 symbol count | u32 form count
+//     symbols: varint length, bytes
+//     forms:   tree nodes in prefix order, each a tag byte followed by
+//              NIL: nothing   NUMBER: zigzag varint   SYMBOL: varint index   CELL: first, second
+
+// 64-bit FNV-1a of the source text; a cache is only used for the source it was built from.
+uint64_t HashSource(std::string_view source);
+
+std::string EncodeForms(const std::vector<Ref<Object>>& forms, uint64_t source_hash);
+
+// Rebuilds the forms. A hash mismatch or damaged data is reported as an error, never undefined
+// behaviour. Every occurrence of a symbol shares one Symbol object.
+Expected<std::vector<Ref<Object>>> DecodeForms(std::string_view data, uint64_t source_hash);
+
+// Writes the encoding to `path` through a temporary file and a rename, so that concurrent
+// readers never see a partial file. Throws RuntimeError on I/O failure.
+void WriteAstFile(const std::string& path, const std::vector<Ref<Object>>& forms,
+                  uint64_t source_hash);
+
+// Memory-maps `path` and decodes it.
+Expected<std::vector<Ref<Object>>> LoadAstFile(const std::string& path, uint64_t source_hash);
+
+// Reads every form of the file at `path`, from the cache at `path + ".ast"` when it was built
+// from the same text, otherwise with ReadAll() and refreshing the cache. Failing to write the
+// cache is not an error. Throws RuntimeError if the source cannot be read and SyntaxError if it
+// is malformed.
+std::vector<Ref<Object>> LoadSourceFile(const std::string& path, ThreadPool* pool = nullptr);
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ast_cache.h>
+#include <lazy_forms.h>
+#include <loader.h>
+#include <parser.h>
+#include <scheme.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Reads `input` repeatedly until at least `min_tokens` tokens went through the reader and
+// returns the average time per token in nanoseconds.
+double NanosPerToken(const std::string& input, size_t tokens_per_read, size_t min_tokens,
+                     const ReaderOptions& options) {
+    size_t rounds = (min_tokens + tokens_per_read - 1) / tokens_per_read;
+    auto start = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        auto result = TryReadFull(input, options);
+        if (!result) {
+            std::fprintf(stderr, "read failed: %s\n", result.Error().message.c_str());
+            std::exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / static_cast<double>(rounds * tokens_per_read);
+}
+
+void BenchNestingDepth() {
+    std::printf("reader throughput by nesting depth\n");
+    std::printf("%10s %12s\n", "depth", "ns/token");
+    for (size_t depth = 10; depth <= 1000000; depth *= 10) {
+        std::string input = std::string(depth, '(') + "1" + std::string(depth, ')');
+        ReaderOptions options{depth};
+        std::printf("%10zu %12.2f\n", depth,
+                    NanosPerToken(input, 2 * depth + 1, 20000000, options));
+    }
+}
+
+// Time per Run() of a request that builds and tears down a large parse tree.
+double MicrosPerRun(Interpreter* interpreter, const std::string& request, size_t rounds) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        interpreter->Run(request);
+    }
+    std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+    return elapsed.count() / static_cast<double>(rounds);
+}
+
+void BenchRegion() {
+    std::string request = "(+";
+    for (int i = 0; i < 10000; ++i) {
+        request += " (* 2 " + std::to_string(i) + ")";
+    }
+    request += ")";
+
+    Interpreter heap;
+    Interpreter region{InterpreterOptions{.use_region = true}};
+    std::printf("\nRun() of a %zu byte request\n", request.size());
+    std::printf("%10s %12.1f us\n", "heap", MicrosPerRun(&heap, request, 200));
+    std::printf("%10s %12.1f us\n", "region", MicrosPerRun(&region, request, 200));
+    Interpreter cached{InterpreterOptions{.parse_cache = std::make_shared<ParseCache>()}};
+    std::printf("%10s %12.1f us\n", "cached", MicrosPerRun(&cached, request, 200));
+}
+
+void BenchGc() {
+    // Every (list ...) leaves a temporary behind for the collector.
+    std::string request = "(or";
+    for (int i = 0; i < 10000; ++i) {
+        request += " (list " + std::to_string(i) + " 'x)";
+    }
+    request += " 1)";
+
+    Interpreter interpreter;
+    std::printf("\nRun() of a %zu byte request with 10000 temporaries\n", request.size());
+    std::printf("%10s %12.1f us\n", "gc", MicrosPerRun(&interpreter, request, 200));
+    auto stats = interpreter.GetGcStats();
+    std::printf("%10s %12.1f us (%llu minor collections)\n", "mean pause",
+                stats.total_pause_ns / 1000.0 / stats.minor_collections,
+                static_cast<unsigned long long>(stats.minor_collections));
+    std::printf("%10s %12.1f us\n", "max pause", stats.max_pause_ns / 1000.0);
+}
+
+// Walks `list` with list? until `min_cells` cells went by; returns the time per cell.
+double NanosPerCell(const Ref<Object>& list, size_t length, size_t min_cells) {
+    Value args[] = {ToValue(list)};
+    size_t rounds = min_cells / length;
+    size_t proper = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        proper += IsList{}(args);
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    if (proper != rounds) {
+        std::exit(1);
+    }
+    return elapsed.count() / static_cast<double>(rounds * length);
+}
+
+void BenchListWalk() {
+    constexpr size_t kLength = 1 << 20;
+    auto element = [](size_t i) { return NumberObject(i % 100); };
+    auto runs = MakeListObject(kLength, element, nullptr);
+
+    // Cell by cell from a shuffled free list, the way a long-running heap hands them out.
+    std::vector<Ref<Object>> slots;
+    for (size_t i = 0; i < 2 * kLength; ++i) {
+        slots.push_back(MakeObject<Cell>());
+    }
+    std::shuffle(slots.begin(), slots.end(), std::mt19937{42});
+    slots.clear();
+    Ref<Object> pairs;
+    for (size_t i = kLength; i > 0; --i) {
+        auto cell = MakeObject<Cell>();
+        cell->AppendFirst(element(i - 1));
+        cell->AppendSecond(std::move(pairs));
+        pairs = std::move(cell);
+    }
+
+    std::printf("\nlist? over a %zu element list\n", kLength);
+    std::printf("%10s %12.2f ns/cell\n", "scattered", NanosPerCell(pairs, kLength, 1 << 25));
+    std::printf("%10s %12.2f ns/cell\n", "runs", NanosPerCell(runs, kLength, 1 << 25));
+}
+
+double MillisPerLoad(const std::string& source, ThreadPool* pool) {
+    auto start = Clock::now();
+    auto forms = ReadAll(source, pool);
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    if (forms.empty()) {
+        std::exit(1);
+    }
+    return elapsed.count();
+}
+
+void BenchLoad() {
+    std::string source;
+    for (int i = 0; source.size() < 4 * 1024 * 1024; ++i) {
+        source += "(define-rule r" + std::to_string(i) + " '(when (> x " + std::to_string(i) +
+                  ") (list a b (c d))))\n";
+    }
+    std::printf("\nReadAll() of a %zu byte file\n", source.size());
+    std::printf("%10s %12.1f ms\n", "serial", MillisPerLoad(source, nullptr));
+    ThreadPool pool;
+    std::printf("%7zu thr %12.1f ms\n", pool.Size(), MillisPerLoad(source, &pool));
+
+    uint64_t hash = HashSource(source);
+    std::string cache = EncodeForms(ReadAll(source), hash);
+    auto start = Clock::now();
+    auto forms = DecodeForms(cache, hash);
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    if (!forms) {
+        std::exit(1);
+    }
+    std::printf("%10s %12.1f ms (%zu byte cache)\n", "cached", elapsed.count(), cache.size());
+    auto cells = ObjectPool<Cell>::Stats();
+    std::printf("%10s %12zu slabs, %.0f%% occupied\n", "cell pool", cells.slabs,
+                100 * cells.Occupancy());
+
+    start = Clock::now();
+    LazyForms lazy{source};
+    elapsed = Clock::now() - start;
+    std::printf("%10s %12.1f ms (%zu forms indexed)\n", "lazy", elapsed.count(), lazy.Size());
+}
+
+}  // namespace
+
+int main() {
+    BenchNestingDepth();
+    BenchRegion();
+    BenchGc();
+    BenchLoad();
+    BenchListWalk();
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "char_class.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SCHEME_X86_SIMD 1
+#include <immintrin.h>
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+template <uint8_t Bits>
+const char* SkipScalar(const char* begin, const char* end) {
+    while (begin != end && HasCharClass(*begin, Bits)) {
+        ++begin;
+    }
+    return begin;
+}
+
+constexpr CharScanner kScalarScanner{SkipScalar<kSpaceBit>, SkipScalar<kSymbolBit>,
+                                     SkipScalar<kDigitBit>};
+
+#ifdef SCHEME_X86_SIMD
+
+// SSE4.2: pcmpestri finds the first byte outside a set of up to 8 ranges (or 16 single bytes)
+// in one instruction, 16 bytes at a time.
+constexpr int kOutsideRanges =
+    _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT;
+constexpr int kOutsideSet =
+    _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT;
+
+// The symbol alphabet packed into 8 ranges: a-z A-Z /-9 <-? * - # !
+alignas(16) const char kSymbolRanges[16] = {'a', 'z', 'A', 'Z', '/', '9', '<', '?',
+                                            '*', '*', '-', '-', '#', '#', '!', '!'};
+alignas(16) const char kDigitRanges[16] = {'0', '9'};
+alignas(16) const char kSpaceSet[16] = {' ', '\n', '\t', '\r'};
+
+template <int Mode, int SetSize, uint8_t Bits>
+__attribute__((target("sse4.2"))) const char* SkipSse42(const char* set, const char* begin,
+                                                          const char* end) {
+    const __m128i needle = _mm_load_si128(reinterpret_cast<const __m128i*>(set));
+    while (end - begin >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int index = _mm_cmpestri(needle, SetSize, chunk, 16, Mode);
+        if (index != 16) {
+            return begin + index;
+        }
+        begin += 16;
+    }
+    return SkipScalar<Bits>(begin, end);
+}
+
+const char* SkipSpacesSse42(const char* begin, const char* end) {
+    return SkipSse42<kOutsideSet, 4, kSpaceBit>(kSpaceSet, begin, end);
+}
+
+const char* SkipSymbolSse42(const char* begin, const char* end) {
+    return SkipSse42<kOutsideRanges, 16, kSymbolBit>(kSymbolRanges, begin, end);
+}
+
+const char* SkipDigitsSse42(const char* begin, const char* end) {
+    return SkipSse42<kOutsideRanges, 2, kDigitBit>(kDigitRanges, begin, end);
+}
+
+// AVX2: build a 32-bit membership mask per chunk from range compares and take the first zero.
+__attribute__((target("avx2"))) inline __m256i InRange(__m256i chunk, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(lo));
+    __m256i clamped = _mm256_min_epu8(shifted, _mm256_set1_epi8(static_cast<char>(hi - lo)));
+    return _mm256_cmpeq_epi8(shifted, clamped);
+}
+
+__attribute__((target("avx2"))) inline __m256i IsByte(__m256i chunk, char c) {
+    return _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c));
+}
+
+struct SpaceMask {
+    __attribute__((target("avx2"))) static __m256i Of(__m256i chunk) {
+        __m256i mask = _mm256_or_si256(IsByte(chunk, ' '), IsByte(chunk, '\n'));
+        return _mm256_or_si256(mask, _mm256_or_si256(IsByte(chunk, '\t'), IsByte(chunk, '\r')));
+    }
+};
+
+struct DigitMask {
+    __attribute__((target("avx2"))) static __m256i Of(__m256i chunk) {
+        return InRange(chunk, '0', '9');
+    }
+};
+
+struct SymbolMask {
+    __attribute__((target("avx2"))) static __m256i Of(__m256i chunk) {
+        // Setting bit 0x20 folds upper case letters onto lower case ones.
+        __m256i letters = InRange(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i mask = _mm256_or_si256(letters, InRange(chunk, '/', '9'));
+        mask = _mm256_or_si256(mask, InRange(chunk, '<', '?'));
+        mask = _mm256_or_si256(mask, _mm256_or_si256(IsByte(chunk, '*'), IsByte(chunk, '-')));
+        return _mm256_or_si256(mask, _mm256_or_si256(IsByte(chunk, '#'), IsByte(chunk, '!')));
+    }
+};
+
+template <class Mask, uint8_t Bits>
+__attribute__((target("avx2"))) const char* SkipAvx2(const char* begin, const char* end) {
+    while (end - begin >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        uint32_t outside = ~static_cast<uint32_t>(_mm256_movemask_epi8(Mask::Of(chunk)));
+        if (outside) {
+            return begin + __builtin_ctz(outside);
+        }
+        begin += 32;
+    }
+    return SkipScalar<Bits>(begin, end);
+}
+
+constexpr CharScanner kSse42Scanner{SkipSpacesSse42, SkipSymbolSse42, SkipDigitsSse42};
+
+constexpr CharScanner kAvx2Scanner{SkipAvx2<SpaceMask, kSpaceBit>,
+                                   SkipAvx2<SymbolMask, kSymbolBit>,
+                                   SkipAvx2<DigitMask, kDigitBit>};
+
+#endif
+
+}  // namespace
+
+ScanLevel DetectScanLevel() {
+#ifdef SCHEME_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ScanLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ScanLevel::SSE42;
+    }
+#endif
+    return ScanLevel::SCALAR;
+}
+
+const CharScanner& GetCharScanner(ScanLevel level) {
+    static const ScanLevel kSupported = DetectScanLevel();
+    if (level > kSupported) {
+        level = kSupported;
+    }
+#ifdef SCHEME_X86_SIMD
+    if (level == ScanLevel::AVX2) {
+        return kAvx2Scanner;
+    }
+    if (level == ScanLevel::SSE42) {
+        return kSse42Scanner;
+    }
+#endif
+    return kScalarScanner;
+}
+
+const CharScanner& GetCharScanner() {
+    static const CharScanner& scanner = GetCharScanner(DetectScanLevel());
+    return scanner;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum CharClassBit : uint8_t {
+    kSpaceBit = 1,
+    kDigitBit = 2,
+    kStartSymbolBit = 4,
+    kSymbolBit = 8,
+};
+
+constexpr std::array<uint8_t, 256> MakeCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    table[' '] = table['\n'] = table['\t'] = table['\r'] = kSpaceBit;
+    for (int c = '0'; c <= '9'; ++c) {
+        table[c] = kDigitBit | kSymbolBit;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        table[c] = table[c - 'a' + 'A'] = kStartSymbolBit | kSymbolBit;
+    }
+    for (char c : {'<', '=', '>', '*', '/', '#'}) {
+        table[static_cast<uint8_t>(c)] = kStartSymbolBit | kSymbolBit;
+    }
+    for (char c : {'?', '!', '-'}) {
+        table[static_cast<uint8_t>(c)] = kSymbolBit;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharClassTable = MakeCharClassTable();
+
+inline bool HasCharClass(char elem, uint8_t bits) {
+    return kCharClassTable[static_cast<uint8_t>(elem)] & bits;
+}
+
+// Each scanner returns the end of the run of characters of its class that starts at `begin`,
+// i.e. the first position in [begin, end) that does not belong to the class, or `end`.
+struct CharScanner {
+    const char* (*skip_spaces)(const char* begin, const char* end);
+    const char* (*skip_symbol)(const char* begin, const char* end);
+    const char* (*skip_digits)(const char* begin, const char* end);
+};
+
+enum class ScanLevel { SCALAR, SSE42, AVX2 };
+
+// Best level supported by the CPU we are running on.
+ScanLevel DetectScanLevel();
+
+// Scanner for the given level; levels the CPU does not support fall back to the best one it does.
+const CharScanner& GetCharScanner(ScanLevel level);
+
+// Scanner for DetectScanLevel(), resolved once.
+const CharScanner& GetCharScanner();
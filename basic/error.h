@@ -1,6 +1,9 @@
 #pragma once
 
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
 
 struct SyntaxError : public std::runtime_error {
     using std::runtime_error::runtime_error;
@@ -13,3 +16,50 @@ struct RuntimeError : public std::runtime_error {
 struct NameError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
+
+// A syntax error returned as a value, for callers that see malformed input routinely and
+// should not pay for unwinding.
+struct ParseError {
+    std::string message;
+};
+
+template <class T>
+class Expected {
+public:
+    Expected(T value) : data_(std::in_place_index<0>, std::move(value)) {
+    }
+
+    Expected(ParseError error) : data_(std::in_place_index<1>, std::move(error)) {
+    }
+
+    bool HasValue() const {
+        return data_.index() == 0;
+    }
+
+    explicit operator bool() const {
+        return HasValue();
+    }
+
+    T& Value() {
+        return std::get<0>(data_);
+    }
+
+    const T& Value() const {
+        return std::get<0>(data_);
+    }
+
+    const ParseError& Error() const {
+        return std::get<1>(data_);
+    }
+
+    // Unwraps the value, turning an error back into a SyntaxError.
+    T ValueOrThrow() && {
+        if (!HasValue()) {
+            throw SyntaxError(Error().message);
+        }
+        return std::move(Value());
+    }
+
+private:
+    std::variant<T, ParseError> data_;
+};
@@ -0,0 +1,72 @@
+#include "event_reader.h"
+
+#include "error.h"
+#include "reader.h"
+
+namespace {
+
+// Passes the input on to a ReadHandler; every reader frame is a couple of bytes instead of a
+// partially built list.
+class EventBuilder {
+public:
+    struct Datum {};
+
+    explicit EventBuilder(ReadHandler* handler) : handler_(handler) {
+    }
+
+    Datum OnNumber(int64_t value) {
+        handler_->OnNumber(value);
+        return {};
+    }
+
+    Datum OnSymbol(std::string_view name) {
+        handler_->OnSymbol(name);
+        return {};
+    }
+
+    void OnBeginList() {
+        handler_->OnBeginList();
+    }
+
+    void OnDot() {
+        handler_->OnDot();
+    }
+
+    void OnElement(Datum) {
+    }
+
+    Datum OnEndList(bool) {
+        handler_->OnEndList();
+        return {};
+    }
+
+    void OnQuote() {
+        handler_->OnQuote();
+    }
+
+    Datum OnEndQuote(Datum) {
+        return {};
+    }
+
+private:
+    ReadHandler* handler_;
+};
+
+}  // namespace
+
+void ReadEvents(Tokenizer* tokenizer, ReadHandler* handler, const ReaderOptions& options) {
+    TokenizerSource source{tokenizer};
+    EventBuilder builder{handler};
+    Reader<TokenizerSource, EventBuilder> reader{&source, &builder, options};
+    EventBuilder::Datum datum;
+    if (!reader.Read(&datum)) {
+        throw SyntaxError(reader.Error().message);
+    }
+}
+
+void ReadAllEvents(Tokenizer* tokenizer, ReadHandler* handler, const ReaderOptions& options) {
+    while (!tokenizer->IsEnd()) {
+        ReadEvents(tokenizer, handler, options);
+        handler->OnDatumEnd();
+    }
+}
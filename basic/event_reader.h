@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "parser.h"
+#include "tokenizer.h"
+
+// Receives the structure of the input while it is being read, without a tree being built. The
+// defaults ignore the event, so a handler overrides only what it needs.
+//
+// "(a . 'b)" arrives as OnBeginList, OnSymbol("a"), OnDot, OnQuote, OnSymbol("b"), OnEndList.
+// A quote is reported as a prefix of the datum it applies to, not expanded to (quote ...).
+class ReadHandler {
+public:
+    virtual ~ReadHandler() = default;
+
+    virtual void OnBeginList() {
+    }
+
+    virtual void OnEndList() {
+    }
+
+    virtual void OnNumber(int64_t) {
+    }
+
+    // `name` is only valid during the call.
+    virtual void OnSymbol(std::string_view) {
+    }
+
+    virtual void OnDot() {
+    }
+
+    virtual void OnQuote() {
+    }
+
+    // A top-level datum is complete; only sent by ReadAllEvents().
+    virtual void OnDatumEnd() {
+    }
+};
+
+// Reads one datum from `tokenizer`, delivering events as tokens arrive. Memory use is bounded
+// by the nesting depth, not the size of the input, so a stream-mode tokenizer can run through
+// inputs of any length. Throws SyntaxError on malformed input, with the events up to the error
+// already delivered.
+void ReadEvents(Tokenizer* tokenizer, ReadHandler* handler, const ReaderOptions& options = {});
+
+// Calls ReadEvents() until the input is exhausted.
+void ReadAllEvents(Tokenizer* tokenizer, ReadHandler* handler,
+                   const ReaderOptions& options = {});
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "char_class.h"
+#include "tokenizer.h"
+
+// Where the top-level forms of a source begin and end, found without tokenizing the lists.
+// FindTopLevelFormEnd() (loader.h) feeds it every byte, StructuralIndex::FormStarts() only the
+// structural positions, and both split alike because this is the one place that decides.
+//
+// A form is a datum with the quotes in front of it. A list runs to its matching bracket; inside
+// it only brackets matter. An atom, a run of bytes that are neither brackets, quotes nor
+// whitespace, holds one datum per token, as the reader sees it: `1a` is the two forms `1` and
+// `a`. A stray ')' is a form of its own, left for the reader to report.
+class FormBoundary {
+public:
+    explicit FormBoundary(std::string_view source) : source_(source) {
+    }
+
+    // Whether the next byte taken begins a form.
+    bool AtStart() const {
+        return depth_ == 0 && !quoted_;
+    }
+
+    // Takes the byte at `pos`, which is not whitespace. Inside a list and inside an atom only
+    // the first byte of a token matters, so the rest of an atom may be left out. Returns the
+    // end of the form that the byte completes, or 0 if it completes none. The end of an atom's
+    // token may lie within the atom; a new form begins there.
+    size_t Take(size_t pos) {
+        char c = source_[pos];
+        if (depth_ > 0) {
+            if (c == '(') {
+                ++depth_;
+            } else if (c == ')' && --depth_ == 0) {
+                return pos + 1;
+            }
+            return 0;
+        }
+        // A quote is not a datum of its own: it goes with whatever follows.
+        quoted_ = c == '\'';
+        if (c == '(') {
+            depth_ = 1;
+            return 0;
+        }
+        if (quoted_) {
+            return 0;
+        }
+        return c == ')' ? pos + 1 : FindTokenEnd(source_, pos);
+    }
+
+    // Whether `pos`, the end of a form, lies within an atom.
+    bool InAtom(size_t pos) const {
+        return pos > 0 && pos < source_.size() && !EndsAtom(source_[pos - 1]) &&
+               !EndsAtom(source_[pos]);
+    }
+
+    static bool EndsAtom(char c) {
+        return c == '(' || c == ')' || c == '\'' || HasCharClass(c, kSpaceBit);
+    }
+
+private:
+    std::string_view source_;
+    size_t depth_ = 0;
+    bool quoted_ = false;
+};
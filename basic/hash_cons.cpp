@@ -0,0 +1,59 @@
+#include "hash_cons.h"
+
+Ref<Object> HashConsTable::MakeNumber(int64_t value) {
+    auto& number = numbers_[value];
+    if (!number) {
+        // Small integers are the shared immortal ones; NumberObject() itself would allocate
+        // larger ones from the current arena.
+        bool cached = value >= kMinCachedNumber && value <= kMaxCachedNumber;
+        number = cached ? NumberObject(value) : MakeHeapObject<Number>(value);
+    }
+    return number;
+}
+
+Ref<Object> HashConsTable::MakeSymbol(std::string_view name) {
+    return MakeSymbol(SymbolTable::Global().Intern(name));
+}
+
+Ref<Object> HashConsTable::MakeSymbol(BuiltinSymbol builtin) {
+    return MakeSymbol(SymbolTable::Global().Get(builtin));
+}
+
+Ref<Object> HashConsTable::MakeSymbol(const InternedSymbol* interned) {
+    auto& symbol = symbols_[interned];
+    if (!symbol) {
+        switch (interned->id) {
+            case ToId(BuiltinSymbol::BOOL_TRUE):
+                symbol = BoolObject(true);
+                break;
+            case ToId(BuiltinSymbol::BOOL_FALSE):
+                symbol = BoolObject(false);
+                break;
+            default:
+                symbol = MakeHeapObject<Symbol>(interned);
+        }
+    }
+    return symbol;
+}
+
+Ref<Object> HashConsTable::MakeCell(const Ref<Object>& first, const Ref<Object>& second) {
+    auto& cell = cells_[CellKey{first.get(), second.get()}];
+    if (!cell) {
+        auto fresh = MakeHeapObject<Cell>();
+        fresh->AppendFirst(first);
+        fresh->AppendSecond(second);
+        cell = std::move(fresh);
+    }
+    return cell;
+}
+
+size_t HashConsTable::Size() const {
+    return numbers_.size() + symbols_.size() + cells_.size();
+}
+
+void HashConsTable::Clear() {
+    // Cells first: they reference the leaves.
+    cells_.clear();
+    numbers_.clear();
+    symbols_.clear();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "object.h"
+#include "symbol_table.h"
+
+// Canonical copies of immutable Number/Symbol/Cell trees: asking twice for the same structure
+// yields the same object, so equal subtrees share one allocation and compare equal by pointer.
+// Trees are built bottom-up, a cell from its already canonical children, which makes each
+// lookup a single hash of two pointers.
+//
+// The table keeps everything it hands out alive until it is cleared or destroyed, and always
+// allocates on the heap, also inside an ArenaScope. Not thread-safe.
+class HashConsTable {
+public:
+    Ref<Object> MakeNumber(int64_t value);
+
+    Ref<Object> MakeSymbol(std::string_view name);
+
+    Ref<Object> MakeSymbol(BuiltinSymbol builtin);
+
+    // `first` and `second` must come from this table (or be null).
+    Ref<Object> MakeCell(const Ref<Object>& first, const Ref<Object>& second);
+
+    // Number of distinct objects held.
+    size_t Size() const;
+
+    void Clear();
+
+private:
+    struct CellKey {
+        const Object* first;
+        const Object* second;
+
+        bool operator==(const CellKey& other) const {
+            return first == other.first && second == other.second;
+        }
+    };
+
+    struct CellKeyHash {
+        size_t operator()(const CellKey& key) const {
+            auto first = reinterpret_cast<uintptr_t>(key.first);
+            auto second = reinterpret_cast<uintptr_t>(key.second);
+            return std::hash<uintptr_t>{}(first * 0x9e3779b97f4a7c15ull ^ second);
+        }
+    };
+
+    Ref<Object> MakeSymbol(const InternedSymbol* interned);
+
+    std::unordered_map<int64_t, Ref<Object>> numbers_;
+    std::unordered_map<const InternedSymbol*, Ref<Object>> symbols_;
+    std::unordered_map<CellKey, Ref<Object>, CellKeyHash> cells_;
+};
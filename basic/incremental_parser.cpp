@@ -0,0 +1,113 @@
+#include "incremental_parser.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "loader.h"
+
+IncrementalParser::IncrementalParser(std::string text, const ReaderOptions& options)
+    : text_(std::move(text)), options_(options) {
+    size_t old = 0;
+    forms_ = Reparse(0, 0, &old, 0);
+}
+
+void IncrementalParser::Edit(size_t offset, size_t length, std::string_view replacement) {
+    if (offset > text_.size() || length > text_.size() - offset) {
+        throw RuntimeError{"edit out of range"};
+    }
+    text_.replace(offset, length, replacement);
+    ptrdiff_t delta = static_cast<ptrdiff_t>(replacement.size()) - static_cast<ptrdiff_t>(length);
+
+    // The first form that ends at or after the edit: text appended right behind a datum may
+    // extend it.
+    auto first = std::lower_bound(forms_.begin(), forms_.end(), offset,
+                                  [](const Form& form, size_t pos) { return form.end < pos; });
+    size_t first_index = first - forms_.begin();
+    size_t begin = first == forms_.end() ? (forms_.empty() ? 0 : forms_.back().end)
+                                         : first->begin;
+    // Old forms that start inside the removed range are gone for sure; the scan below may
+    // swallow more if the edit unbalanced brackets.
+    size_t old = first_index;
+    while (old < forms_.size() && forms_[old].begin < offset + length) {
+        ++old;
+    }
+    auto fresh = Reparse(begin, offset + replacement.size(), &old, delta);
+
+    // Bounded by the size of the buffer, give or take a few edits.
+    if (retired_.size() > forms_.size() + 64) {
+        retired_.clear();
+    }
+    for (size_t i = first_index; i < old; ++i) {
+        // Only forms clear of the edit still have their text at a known place.
+        const Form& form = forms_[i];
+        if (!form.trees) {
+            continue;
+        }
+        if (form.end <= offset) {
+            retired_.emplace(text_.substr(form.begin, form.end - form.begin), form.trees.Value());
+        } else if (form.begin >= offset + length) {
+            retired_.emplace(text_.substr(form.begin + delta, form.end - form.begin),
+                             form.trees.Value());
+        }
+    }
+    for (size_t i = old; i < forms_.size(); ++i) {
+        forms_[i].begin += delta;
+        forms_[i].end += delta;
+    }
+    forms_.erase(forms_.begin() + first_index, forms_.begin() + old);
+    forms_.insert(forms_.begin() + first_index, std::make_move_iterator(fresh.begin()),
+                  std::make_move_iterator(fresh.end()));
+}
+
+std::vector<IncrementalParser::Form> IncrementalParser::Reparse(size_t pos, size_t stop,
+                                                                size_t* old, ptrdiff_t delta) {
+    LoadOptions options{options_, std::numeric_limits<size_t>::max()};
+    std::vector<Form> fresh;
+    last_reparsed_ = 0;
+    while (pos < text_.size()) {
+        while (*old < forms_.size() && forms_[*old].begin + delta < pos) {
+            ++*old;
+        }
+        // Past the edit, a form boundary that was there before means the rest is unchanged.
+        if (pos >= stop && *old < forms_.size() && forms_[*old].begin + delta == pos) {
+            break;
+        }
+        size_t end = FindTopLevelFormEnd(text_, pos);
+        auto text = std::string_view(text_).substr(pos, end - pos);
+        if (auto it = retired_.find(std::string(text)); it != retired_.end()) {
+            fresh.push_back(Form{pos, end, std::move(it->second)});
+            retired_.erase(it);
+        } else {
+            fresh.push_back(Form{pos, end, TryReadAll(text, nullptr, options)});
+            last_reparsed_ += end - pos;
+        }
+        pos = end;
+    }
+    while (*old < forms_.size() && forms_[*old].begin + delta < pos) {
+        ++*old;
+    }
+    return fresh;
+}
+
+const std::string& IncrementalParser::Text() const {
+    return text_;
+}
+
+const std::vector<IncrementalParser::Form>& IncrementalParser::Forms() const {
+    return forms_;
+}
+
+Expected<std::vector<Ref<Object>>> IncrementalParser::Trees() const {
+    std::vector<Ref<Object>> trees;
+    for (const auto& form : forms_) {
+        if (!form.trees) {
+            return form.trees.Error();
+        }
+        trees.insert(trees.end(), form.trees.Value().begin(), form.trees.Value().end());
+    }
+    return trees;
+}
+
+size_t IncrementalParser::LastReparsedBytes() const {
+    return last_reparsed_;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "parser.h"
+
+// Parse state of a buffer that is edited in place, e.g. by an editor or a REPL. The buffer is
+// kept as a sequence of top-level forms; an edit re-lexes and re-parses only the forms it
+// touches and keeps the trees of all others, so the parsing work per edit depends on the size
+// of the edited forms, not of the buffer.
+//
+// An unbalanced bracket makes one form swallow the rest of the buffer. The forms it replaced
+// are remembered by their text, so closing the bracket again brings their trees back after a
+// cheap bracket scan instead of a full parse.
+class IncrementalParser {
+public:
+    // One top-level datum with the whitespace before it, covering [begin, end) of Text(). The
+    // trees are usually a single one; none for trailing whitespace, several for data that are
+    // not separated by whitespace, as in "1a".
+    struct Form {
+        size_t begin;
+        size_t end;
+        Expected<std::vector<Ref<Object>>> trees;
+    };
+
+    explicit IncrementalParser(std::string text = "", const ReaderOptions& options = {});
+
+    // Replaces `length` bytes at `offset` with `replacement`. Throws RuntimeError if the range
+    // is not inside the buffer.
+    void Edit(size_t offset, size_t length, std::string_view replacement);
+
+    const std::string& Text() const;
+
+    // Covers the whole text, in order. Trees that an edit did not touch are the same objects as
+    // before it.
+    const std::vector<Form>& Forms() const;
+
+    // Every tree of the buffer, or the first syntax error in it.
+    Expected<std::vector<Ref<Object>>> Trees() const;
+
+    // Bytes tokenized and parsed by the last Edit() or the constructor.
+    size_t LastReparsedBytes() const;
+
+private:
+    // Parses forms from `pos` on until a form would start at `stop`, or at a boundary of the
+    // old forms from index `*old` on once past `stop`, and returns them. `*old` ends at the
+    // first old form that is still valid; old boundaries are shifted by `delta`.
+    std::vector<Form> Reparse(size_t pos, size_t stop, size_t* old, ptrdiff_t delta);
+
+    std::string text_;
+    ReaderOptions options_;
+    std::vector<Form> forms_;
+    // Parse results of forms dropped by recent edits, keyed by their text.
+    std::unordered_map<std::string, std::vector<Ref<Object>>> retired_;
+    size_t last_reparsed_ = 0;
+};
@@ -0,0 +1,38 @@
+#include "lazy_forms.h"
+
+#include "arena.h"
+
+LazyForms::LazyForms(std::string_view source, const ReaderOptions& options)
+    : source_(source),
+      options_(options),
+      starts_(BuildStructuralIndex(source).FormStarts(source)),
+      forms_(starts_.size()) {
+}
+
+size_t LazyForms::Size() const {
+    return starts_.size();
+}
+
+std::string_view LazyForms::Text(size_t index) const {
+    size_t end = index + 1 < starts_.size() ? starts_[index + 1] : source_.size();
+    return source_.substr(starts_[index], end - starts_[index]);
+}
+
+Expected<Ref<Object>> LazyForms::TryGet(size_t index) {
+    auto& form = forms_.at(index);
+    if (!form) {
+        // Read forms are kept for later calls, so they cannot live in a request's arena.
+        ArenaScope heap{nullptr};
+        form = TryReadFull(Text(index), options_);
+        ++read_count_;
+    }
+    return *form;
+}
+
+Ref<Object> LazyForms::Get(size_t index) {
+    return TryGet(index).ValueOrThrow();
+}
+
+size_t LazyForms::ReadCount() const {
+    return read_count_;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "parser.h"
+#include "structural_index.h"
+
+// The top-level forms of a source, each read only when it is first asked for. Construction
+// costs one structural-index pass over the bytes; tokenizing and building trees is paid per
+// form used. Syntax errors surface when the broken form is read.
+//
+// Not thread-safe. The source must outlive the object.
+class LazyForms {
+public:
+    explicit LazyForms(std::string_view source, const ReaderOptions& options = {});
+
+    size_t Size() const;
+
+    // Text of the form, from its first byte up to the start of the next one.
+    std::string_view Text(size_t index) const;
+
+    // Reads the form on first use. Each form must hold exactly one datum, as for ReadFull().
+    Expected<Ref<Object>> TryGet(size_t index);
+
+    // Same as TryGet(), but throws SyntaxError.
+    Ref<Object> Get(size_t index);
+
+    // Number of forms read so far.
+    size_t ReadCount() const;
+
+private:
+    std::string_view source_;
+    ReaderOptions options_;
+    std::vector<uint32_t> starts_;
+    std::vector<std::optional<Expected<Ref<Object>>>> forms_;
+    size_t read_count_ = 0;
+};
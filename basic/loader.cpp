@@ -0,0 +1,93 @@
+#include "loader.h"
+
+#include "arena.h"
+#include "char_class.h"
+#include "form_boundary.h"
+
+namespace {
+
+Expected<std::vector<Ref<Object>>> ReadChunk(std::string_view chunk, const ReaderOptions& options) {
+    auto tokens = TryTokenize(chunk);
+    if (!tokens) {
+        return tokens.Error();
+    }
+    std::vector<Ref<Object>> forms;
+    size_t pos = 0;
+    while (pos != tokens.Value().Size()) {
+        auto form = TryRead(tokens.Value(), &pos, options);
+        if (!form) {
+            return form.Error();
+        }
+        forms.push_back(std::move(form.Value()));
+    }
+    return forms;
+}
+
+}  // namespace
+
+size_t FindTopLevelFormEnd(std::string_view source, size_t pos) {
+    FormBoundary boundary(source);
+    for (; pos < source.size(); ++pos) {
+        if (HasCharClass(source[pos], kSpaceBit)) {
+            continue;
+        }
+        if (size_t end = boundary.Take(pos)) {
+            return end;
+        }
+    }
+    return pos;
+}
+
+std::vector<std::string_view> SplitTopLevelForms(std::string_view source,
+                                                 size_t min_chunk_bytes) {
+    std::vector<std::string_view> chunks;
+    size_t chunk_begin = 0;
+    size_t pos = 0;
+    while (pos < source.size()) {
+        pos = FindTopLevelFormEnd(source, pos);
+        if (pos - chunk_begin >= min_chunk_bytes) {
+            chunks.push_back(source.substr(chunk_begin, pos - chunk_begin));
+            chunk_begin = pos;
+        }
+    }
+    if (chunk_begin < source.size()) {
+        chunks.push_back(source.substr(chunk_begin));
+    }
+    return chunks;
+}
+
+Expected<std::vector<Ref<Object>>> TryReadAll(std::string_view source, ThreadPool* pool,
+                                              const LoadOptions& options) {
+    auto chunks = SplitTopLevelForms(source, options.min_chunk_bytes);
+    std::vector<Expected<std::vector<Ref<Object>>>> results(
+        chunks.size(), ParseError{});
+    auto read_chunk = [&](size_t index) {
+        // Arenas belong to one thread and die with their request; loaded forms must do neither.
+        ArenaScope heap{nullptr};
+        results[index] = ReadChunk(chunks[index], options.reader);
+    };
+    // A hash-consing table is not thread-safe.
+    if (pool && !options.reader.hash_cons) {
+        pool->ParallelFor(chunks.size(), read_chunk);
+    } else {
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            read_chunk(i);
+        }
+    }
+
+    std::vector<Ref<Object>> forms;
+    for (auto& result : results) {
+        if (!result) {
+            return result.Error();
+        }
+        auto& chunk_forms = result.Value();
+        forms.insert(forms.end(), std::make_move_iterator(chunk_forms.begin()),
+                     std::make_move_iterator(chunk_forms.end()));
+    }
+    return forms;
+}
+
+std::vector<Ref<Object>> ReadAll(std::string_view source, ThreadPool* pool,
+                                 const LoadOptions& options) {
+    return TryReadAll(source, pool, options).ValueOrThrow();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "parser.h"
+#include "thread_pool.h"
+
+struct LoadOptions {
+    ReaderOptions reader;
+    // Top-level forms are handed to the workers in batches of at least this many bytes, so
+    // that a file of many small forms is not split into many tiny tasks.
+    size_t min_chunk_bytes = 64 * 1024;
+};
+
+// End of the top-level datum that follows `pos`, including the whitespace and quotes before it,
+// or the end of `source` if only whitespace is left. Forms are as FormBoundary (form_boundary.h)
+// splits them: lists are only bracket-matched, so this is much cheaper than tokenizing.
+size_t FindTopLevelFormEnd(std::string_view source, size_t pos);
+
+// Splits `source` into consecutive pieces that each hold whole top-level forms, the last one
+// possibly malformed, by repeated FindTopLevelFormEnd(). Every piece but the last is at least
+// `min_chunk_bytes` long.
+std::vector<std::string_view> SplitTopLevelForms(std::string_view source,
+                                                 size_t min_chunk_bytes);
+
+// Reads every top-level form of `source`, parsing the pieces found by SplitTopLevelForms() in
+// parallel on `pool`, or on the calling thread if it is null. Forms come back in source order;
+// on malformed input the error of the first bad form is returned. The forms are allocated on
+// the heap even if the calling thread has a current arena. With hash consing the pieces are
+// read on the calling thread.
+Expected<std::vector<Ref<Object>>> TryReadAll(std::string_view source, ThreadPool* pool = nullptr,
+                                              const LoadOptions& options = {});
+
+// Same as TryReadAll(), but throws SyntaxError on malformed input.
+std::vector<Ref<Object>> ReadAll(std::string_view source, ThreadPool* pool = nullptr,
+                                 const LoadOptions& options = {});
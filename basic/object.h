@@ -1,36 +1,302 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <atomic>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <span>
+#include <string>
 #include <vector>
+#include "arena.h"
 #include "error.h"
+#include "pool.h"
+#include "symbol_table.h"
+#include "value.h"
 
 class Object;
 
+// Owning handle to an interpreter object. The reference count is stored in the object and
+// updated without atomics, because an interpreter and its objects stay on one thread. Objects
+// that are handed to other threads while still in use must be marked with
+// ShareAcrossThreads() first; their count is updated atomically from then on.
 template <class T>
-std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
-    std::shared_ptr<T> p = std::dynamic_pointer_cast<T>(obj);
-    return p;
-}
+class Ref {
+public:
+    Ref() = default;
 
-template <class T>
-bool Is(const std::shared_ptr<Object>& obj) {
-    auto p = std::dynamic_pointer_cast<T>(obj);
-    if (p) {
-        return true;
+    Ref(std::nullptr_t) {
+    }
+
+    // Takes a new reference to `object`.
+    explicit Ref(T* object) : ptr_(object) {
+        if (ptr_) {
+            ptr_->Retain();
+        }
+    }
+
+    Ref(const Ref& other) : Ref(other.ptr_) {
+    }
+
+    template <class U>
+        requires std::is_convertible_v<U*, T*>
+    Ref(const Ref<U>& other) : Ref(other.get()) {
+    }
+
+    Ref(Ref&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {
+    }
+
+    template <class U>
+        requires std::is_convertible_v<U*, T*>
+    Ref(Ref<U>&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {
+    }
+
+    ~Ref() {
+        if (ptr_) {
+            ptr_->Release();
+        }
+    }
+
+    Ref& operator=(Ref other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        return *this;
+    }
+
+    T* get() const {
+        return ptr_;
+    }
+
+    T* operator->() const {
+        return ptr_;
+    }
+
+    T& operator*() const {
+        return *ptr_;
+    }
+
+    explicit operator bool() const {
+        return ptr_ != nullptr;
+    }
+
+    uint32_t use_count() const {
+        return ptr_ ? ptr_->RefCount() : 0;
+    }
+
+    void reset() {
+        Ref{}.swap(*this);
     }
-    return false;
-}
 
-class Object : public std::enable_shared_from_this<Object> {
+    void swap(Ref& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+    }
+
+    template <class U>
+    bool operator==(const Ref<U>& other) const {
+        return ptr_ == other.get();
+    }
+
+    bool operator==(std::nullptr_t) const {
+        return ptr_ == nullptr;
+    }
+
+private:
+    template <class U>
+    friend class Ref;
+
+    T* ptr_ = nullptr;
+};
+
+template <class T, class... Args>
+Ref<T> MakeObject(Args&&... args);
+
+template <class T, class... Args>
+Ref<T> MakeHeapObject(Args&&... args);
+
+// Concrete kind of an object, fixed at construction.
+enum class ObjectType : uint8_t { NUMBER, SYMBOL, CELL, BUILTIN };
+
+class Object {
 public:
     virtual ~Object() = default;
+
+    ObjectType GetType() const {
+        return type_;
+    }
+
+    void Retain() const {
+        if (mode_ == RefMode::LOCAL) {
+            ++refs_;
+        } else if (mode_ == RefMode::SHARED) {
+            std::atomic_ref{refs_}.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Release() const {
+        if (mode_ == RefMode::LOCAL) {
+            if (--refs_ != 0) {
+                return;
+            }
+        } else if (mode_ == RefMode::SHARED) {
+            if (std::atomic_ref{refs_}.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+        } else {
+            return;
+        }
+        // Arena memory is released with the arena.
+        if (in_arena_) {
+            this->~Object();
+        } else {
+            delete this;
+        }
+    }
+
+    // Meaningless for immortal objects.
+    uint32_t RefCount() const {
+        return mode_ == RefMode::LOCAL ? refs_
+                                       : std::atomic_ref{refs_}.load(std::memory_order_relaxed);
+    }
+
+    // Whether the caller holds the only reference. For a shared object this is an acquire load
+    // that pairs with the release in other threads' Release(), so what they did with the object
+    // before dropping their references is visible once this returns true.
+    bool IsUnique() const {
+        if (mode_ == RefMode::LOCAL) {
+            return refs_ == 1;
+        }
+        return mode_ == RefMode::SHARED &&
+               std::atomic_ref{refs_}.load(std::memory_order_acquire) == 1;
+    }
+
+    // Whether any thread may use the object: it was shared, or it is immortal.
+    bool IsShared() const {
+        return mode_ != RefMode::LOCAL;
+    }
+
+    bool IsImmortal() const {
+        return mode_ == RefMode::IMMORTAL;
+    }
+
+    // Scratch bits of the interpreter's collector.
+    uint8_t GetGcBits() const {
+        return gc_bits_;
+    }
+
+    void SetGcBits(uint8_t bits) const {
+        gc_bits_ = bits;
+    }
+
+protected:
+    explicit Object(ObjectType type) : type_(type) {
+    }
+
+    // A copy starts with no references.
+    Object(const Object& other) : type_(other.type_) {
+    }
+
+    Object& operator=(const Object&) = delete;
+
+private:
+    template <class T, class... Args>
+    friend Ref<T> MakeObject(Args&&... args);
+
+    template <class T, class... Args>
+    friend T* MakeImmortal(Args&&... args);
+
+    template <class Element>
+    friend Ref<Object> MakeListObject(size_t length, Element element, Ref<Object> tail);
+
+    friend void ShareAcrossThreads(const Ref<Object>& tree);
+
+    // LOCAL counts are updated by one thread, SHARED ones atomically, and IMMORTAL objects are
+    // never counted or freed.
+    enum class RefMode : uint8_t { LOCAL, SHARED, IMMORTAL };
+
+    ObjectType type_;
+    bool in_arena_ = false;
+    mutable RefMode mode_ = RefMode::LOCAL;
+    mutable uint8_t gc_bits_ = 0;
+    alignas(std::atomic_ref<uint32_t>::required_alignment) mutable uint32_t refs_ = 0;
+};
+
+// Every interpreter object is created through here. Inside an ArenaScope the object comes from
+// the scope's arena, otherwise from the heap, i.e. the type's ObjectPool for Number, Symbol
+// and Cell.
+template <class T, class... Args>
+Ref<T> MakeObject(Args&&... args) {
+    if (Arena* arena = Arena::Current()) {
+        T* object = ::new (arena->Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        object->in_arena_ = true;
+        return Ref<T>(object);
+    }
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+// On the regular heap even inside an ArenaScope, for objects that outlive the arena.
+template <class T, class... Args>
+Ref<T> MakeHeapObject(Args&&... args) {
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+// Immortal objects are never freed and their counts are never touched, so they are safe to use
+// from any thread without atomics.
+template <class T, class... Args>
+T* MakeImmortal(Args&&... args) {
+    T* object = new T(std::forward<Args>(args)...);
+    object->mode_ = Object::RefMode::IMMORTAL;
+    return object;
+}
+
+// Is/As compare the type tag against T::kType, so they cost neither RTTI nor a reference count.
+// As returns a pointer borrowed from `obj`, or null if `obj` is not a T.
+template <class T>
+bool Is(const Object* obj) {
+    return obj && obj->GetType() == T::kType;
+}
+
+template <class T>
+bool Is(const Ref<Object>& obj) {
+    return Is<T>(obj.get());
+}
+
+template <class T>
+T* As(Object* obj) {
+    return Is<T>(obj) ? static_cast<T*>(obj) : nullptr;
+}
+
+template <class T>
+const T* As(const Object* obj) {
+    return Is<T>(obj) ? static_cast<const T*>(obj) : nullptr;
+}
+
+template <class T>
+T* As(const Ref<Object>& obj) {
+    return As<T>(obj.get());
+}
+
+// Base of the builtin function objects.
+class Builtin : public Object {
+protected:
+    Builtin() : Object(ObjectType::BUILTIN) {
+    }
 };
 
 class Number : public Object {
 public:
-    Number(int64_t value) : value_(value) {
+    static constexpr ObjectType kType = ObjectType::NUMBER;
+
+    static void* operator new(size_t) {
+        return ObjectPool<Number>::Allocate();
+    }
+
+    static void operator delete(void* object) {
+        ObjectPool<Number>::Free(object);
+    }
+
+    Number(int64_t value) : Object(kType), value_(value) {
     }
-    int GetValue() const {
+    int64_t GetValue() const {
         return value_;
     };
 
@@ -38,524 +304,620 @@ private:
     int64_t value_;
 };
 
+// Symbols are interned: equal names share one InternedSymbol, so comparing symbols or matching
+// a builtin is an integer compare.
 class Symbol : public Object {
 public:
-    Symbol(std::string name) : name_(name) {
+    static constexpr ObjectType kType = ObjectType::SYMBOL;
+
+    static void* operator new(size_t) {
+        return ObjectPool<Symbol>::Allocate();
+    }
+
+    static void operator delete(void* object) {
+        ObjectPool<Symbol>::Free(object);
+    }
+
+    Symbol(std::string_view name)
+        : Object(kType), interned_(SymbolTable::Global().Intern(name)) {
+    }
+
+    Symbol(BuiltinSymbol builtin) : Object(kType), interned_(SymbolTable::Global().Get(builtin)) {
     }
+
+    explicit Symbol(const InternedSymbol* interned) : Object(kType), interned_(interned) {
+    }
+
+    Symbol(const Symbol&) = default;
+
     const std::string& GetName() const {
-        return name_;
+        return interned_->name;
     };
 
-private:
-    std::string name_;
-};
+    SymbolId GetId() const {
+        return interned_->id;
+    }
 
-class CloseBracket : public Object {
-    bool operator==(const CloseBracket&) const {
-        return true;
+    bool Matches(BuiltinSymbol builtin) const {
+        return GetId() == ToId(builtin);
     }
+
+    const InternedSymbol* GetInterned() const {
+        return interned_;
+    }
+
+private:
+    const InternedSymbol* interned_;
 };
 
 class Cell : public Object {
 public:
-    Cell() = default;
-    Cell(std::shared_ptr<Object>& first) : first_(first), second_(nullptr){};
-    std::shared_ptr<Object> GetFirst() const {
+    static constexpr ObjectType kType = ObjectType::CELL;
+
+    static void* operator new(size_t) {
+        return ObjectPool<Cell>::Allocate();
+    }
+
+    static void operator delete(void* object) {
+        ObjectPool<Cell>::Free(object);
+    }
+
+    Cell() : Object(kType) {
+    }
+    Cell(const Cell&) = default;
+    Cell(Cell&&) = default;
+
+    // Uniquely owned sub-cells are torn down from a worklist rather than by recursion, so
+    // freeing a long or deeply nested list cannot overflow the stack.
+    ~Cell() override {
+        // Proper lists are released iteratively along the spine without any bookkeeping.
+        Ref<Object> next = std::move(second_);
+        while (OwnsCell(next) && !OwnsCell(static_cast<Cell*>(next.get())->first_)) {
+            next = std::move(static_cast<Cell*>(next.get())->second_);
+        }
+        if (!OwnsCell(first_) && !OwnsCell(next)) {
+            return;
+        }
+        std::vector<Ref<Object>> pending;
+        pending.push_back(std::move(first_));
+        pending.push_back(std::move(next));
+        while (!pending.empty()) {
+            auto object = std::move(pending.back());
+            pending.pop_back();
+            if (OwnsCell(object)) {
+                auto cell = static_cast<Cell*>(object.get());
+                pending.push_back(std::move(cell->first_));
+                pending.push_back(std::move(cell->second_));
+            }
+        }
+    }
+
+    Cell(Ref<Object>& first) : Object(kType), first_(first), second_(nullptr){};
+    const Ref<Object>& GetFirst() const {
         return first_;
     };
-    std::shared_ptr<Object> GetSecond() const {
+    const Ref<Object>& GetSecond() const {
         return second_;
     };
-    void AppendFirst(std::shared_ptr<Object> object) {
+
+    // The next pair of the list, or null at its end. The cells of a list built in one go sit
+    // in adjacent slots, each cdr pointing at the following one (CDR coding), so a walk along
+    // such a run goes on at the predicted address instead of waiting for every cdr to load.
+    // The slot after the last cell of a run may hold an object of another type, e.g. at the end
+    // of a slab, so the adjacent object is still checked to be a pair.
+    const Cell* Next() const {
+        const Cell* adjacent = this + 1;
+        if (second_.get() == adjacent && adjacent->GetType() == kType) [[likely]] {
+            return adjacent;
+        }
+        return As<Cell>(second_.get());
+    }
+
+    void AppendFirst(Ref<Object> object) {
         first_ = object;
     };
 
-    void AppendSecond(std::shared_ptr<Object> object) {
+    void AppendSecond(Ref<Object> object) {
         second_ = object;
     };
 
 private:
-    std::shared_ptr<Object> first_ = nullptr;
-    std::shared_ptr<Object> second_ = nullptr;
+    static bool OwnsCell(const Ref<Object>& object) {
+        return Is<Cell>(object) && object->IsUnique();
+    }
+
+    Ref<Object> first_ = nullptr;
+    Ref<Object> second_ = nullptr;
 };
 
-class IsNumber : public Object {
-public:
-    IsNumber() = default;
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool isnumber = true;
-        for (auto elem : args) {
-            if (!Is<Number>(elem)) {
-                isnumber = false;
-                break;
+// Builds the list (element(0) ... element(length - 1) . tail) with its cells packed into runs
+// of adjacent slots, see Cell::Next(). The runs stay ordinary pairs: a cdr can be replaced or
+// shared like any other, a walk then simply follows the pointer.
+template <class Element>
+Ref<Object> MakeListObject(size_t length, Element element, Ref<Object> tail) {
+    Arena* arena = Arena::Current();
+    Ref<Object> list;
+    Cell* last = nullptr;
+    for (size_t i = 0; i < length;) {
+        size_t count = length - i;
+        void* run = arena ? arena->Allocate(count * sizeof(Cell), alignof(Cell))
+                          : ObjectPool<Cell>::AllocateRun(count, &count);
+        // The whole run is linked into the list before any element is made, so that if
+        // element() throws, every slot taken is freed with the list.
+        Cell* cells = static_cast<Cell*>(run);
+        for (Cell* cell = cells; cell != cells + count; ++cell) {
+            ::new (cell) Cell();
+            cell->in_arena_ = arena != nullptr;
+            if (last) {
+                last->AppendSecond(Ref<Object>(cell));
+            } else {
+                list = Ref<Object>(cell);
             }
+            last = cell;
         }
-        if (isnumber) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
+        for (Cell* cell = cells; cell != cells + count; ++cell, ++i) {
+            cell->AppendFirst(element(i));
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
     }
-};
+    if (!last) {
+        return tail;
+    }
+    last->AppendSecond(std::move(tail));
+    return list;
+}
 
-class Equal : public Object {
-public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool equal = true;
-        for (auto elem : args) {
-            if (!Is<Number>(elem)) {
-                throw RuntimeError{"runtime-error"};
-            }
-            if (As<Number>(elem)->GetValue() != As<Number>(args[0])->GetValue()) {
-                equal = false;
-                break;
-            }
-        }
-        if (equal) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
+// Immortal #t, #f and ().
+inline Ref<Object> BoolObject(bool value) {
+    static Symbol* const kTrue = MakeImmortal<Symbol>(BuiltinSymbol::BOOL_TRUE);
+    static Symbol* const kFalse = MakeImmortal<Symbol>(BuiltinSymbol::BOOL_FALSE);
+    return Ref<Object>(value ? kTrue : kFalse);
+}
+
+inline Ref<Object> EmptyListObject() {
+    static Symbol* const kEmptyList = MakeImmortal<Symbol>(BuiltinSymbol::EMPTY_LIST);
+    return Ref<Object>(kEmptyList);
+}
+
+inline constexpr int64_t kMinCachedNumber = -256;
+inline constexpr int64_t kMaxCachedNumber = 1023;
+
+// An immortal shared Number for integers in [kMinCachedNumber, kMaxCachedNumber], a new one
+// otherwise.
+inline Ref<Object> NumberObject(int64_t value) {
+    if (value < kMinCachedNumber || value > kMaxCachedNumber) {
+        return MakeObject<Number>(value);
+    }
+    static Number* const* const kCache = [] {
+        auto cache = new Number*[kMaxCachedNumber - kMinCachedNumber + 1];
+        for (int64_t i = kMinCachedNumber; i <= kMaxCachedNumber; ++i) {
+            cache[i - kMinCachedNumber] = MakeImmortal<Number>(i);
+        }
+        return cache;
+    }();
+    return Ref<Object>(kCache[value - kMinCachedNumber]);
+}
+
+// The Symbol for an interned name; #t and #f are the immortal ones.
+inline Ref<Object> SymbolObject(std::string_view name) {
+    const InternedSymbol* interned = SymbolTable::Global().Intern(name);
+    switch (interned->id) {
+        case ToId(BuiltinSymbol::BOOL_TRUE):
+            return BoolObject(true);
+        case ToId(BuiltinSymbol::BOOL_FALSE):
+            return BoolObject(false);
+        default:
+            return MakeObject<Symbol>(interned);
+    }
+}
+
+// Switches every object of a tree to atomic reference counting, so that references to it may
+// be taken and dropped on several threads at once. Must be called while the tree is still
+// confined to one thread.
+inline void ShareAcrossThreads(const Ref<Object>& tree) {
+    std::vector<const Object*> pending{tree.get()};
+    while (!pending.empty()) {
+        const Object* object = pending.back();
+        pending.pop_back();
+        // A shared object's subtree is shared already; this also keeps DAGs linear.
+        if (!object || object->mode_ != Object::RefMode::LOCAL) {
+            continue;
+        }
+        object->mode_ = Object::RefMode::SHARED;
+        if (auto cell = As<Cell>(object)) {
+            pending.push_back(cell->GetFirst().get());
+            pending.push_back(cell->GetSecond().get());
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
     }
-};
+}
 
-class Increasing : public Object {
-public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool increase = true;
-        for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i - 1]) || !Is<Number>(args[i])) {
-                throw RuntimeError{"runtime-error"};
-            }
-            if (As<Number>(args[i])->GetValue() >= As<Number>(args[i - 1])->GetValue()) {
-                increase = false;
-                break;
-            }
+// Deep copy of a Number/Symbol/Cell tree on the regular heap, for values that have to outlive
+// the arena they were built in.
+inline Ref<Object> PromoteToHeap(const Ref<Object>& object) {
+    struct Pending {
+        const Object* source;
+        Cell* parent;
+        bool is_first;
+    };
+    Ref<Object> result;
+    std::vector<Pending> pending{{object.get(), nullptr, false}};
+    while (!pending.empty()) {
+        auto [source, parent, is_first] = pending.back();
+        pending.pop_back();
+        Ref<Object> copy;
+        if (source && source->IsImmortal()) {
+            copy = Ref<Object>(const_cast<Object*>(source));
+        } else if (auto number = As<Number>(source)) {
+            copy = MakeHeapObject<Number>(number->GetValue());
+        } else if (auto symbol = As<Symbol>(source)) {
+            copy = MakeHeapObject<Symbol>(*symbol);
+        } else if (auto cell = As<Cell>(source)) {
+            auto cell_copy = MakeHeapObject<Cell>();
+            pending.push_back({cell->GetFirst().get(), cell_copy.get(), true});
+            pending.push_back({cell->GetSecond().get(), cell_copy.get(), false});
+            copy = std::move(cell_copy);
+        }
+        if (!parent) {
+            result = std::move(copy);
+        } else if (is_first) {
+            parent->AppendFirst(std::move(copy));
+        } else {
+            parent->AppendSecond(std::move(copy));
         }
-        if (increase) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
+    }
+    return result;
+}
+
+inline int64_t Value::GetNumber() const {
+    return IsFixnum() ? GetFixnum() : GetBoxed()->GetValue();
+}
+
+// The value of an object, which must outlive it: numbers that fit become fixnums, #t, #f and ()
+// immediates, other symbols symbol values; anything else is borrowed. A null object is the
+// empty list, as in parse trees.
+inline Value ToValue(Object* object) {
+    if (!object) {
+        return Value::Nil();
+    }
+    if (auto number = As<Number>(object)) {
+        int64_t value = number->GetValue();
+        return Value::FitsFixnum(value) ? Value::Fixnum(value) : Value::Boxed(number);
+    }
+    if (auto symbol = As<Symbol>(object)) {
+        switch (symbol->GetId()) {
+            case ToId(BuiltinSymbol::BOOL_TRUE):
+                return Value::Bool(true);
+            case ToId(BuiltinSymbol::BOOL_FALSE):
+                return Value::Bool(false);
+            case ToId(BuiltinSymbol::EMPTY_LIST):
+                return Value::Nil();
+            default:
+                return Value::Symbol(symbol->GetInterned());
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
     }
-};
+    return Value::Heap(object);
+}
+
+inline Value ToValue(const Ref<Object>& object) {
+    return ToValue(object.get());
+}
+
+// The cell a value points at, or null.
+inline Cell* AsCell(Value value) {
+    return value.IsHeap() ? As<Cell>(value.GetHeap()) : nullptr;
+}
+
+// An owning object for a value; inline values are boxed into a new object.
+inline Ref<Object> ToObject(Value value) {
+    if (value.IsFixnum()) {
+        return NumberObject(value.GetFixnum());
+    } else if (value.IsTrue()) {
+        return BoolObject(true);
+    } else if (value.IsFalse()) {
+        return BoolObject(false);
+    } else if (value.IsNil()) {
+        return EmptyListObject();
+    } else if (value.IsSymbol()) {
+        return MakeObject<Symbol>(value.GetSymbol());
+    } else if (value.IsBoxed()) {
+        return Ref<Object>(const_cast<Number*>(value.GetBoxed()));
+    } else if (value.IsHeap()) {
+        return Ref<Object>(value.GetHeap());
+    }
+    return nullptr;
+}
 
-class Decreasing : public Object {
+// The builtins below work on evaluated arguments as values. Predicates return bool and
+// arithmetic returns int64_t; the interpreter turns those back into values, so none of them
+// allocates.
+
+class IsNumber : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool decrease = true;
-        for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i - 1]) || !Is<Number>(args[i])) {
-                throw RuntimeError{"runtime-error"};
-            }
-            if (As<Number>(args[i])->GetValue() <= As<Number>(args[i - 1])->GetValue()) {
-                decrease = false;
-                break;
+    IsNumber() = default;
+    bool operator()(std::span<const Value> args) {
+        for (auto elem : args) {
+            if (!elem.IsNumber()) {
+                return false;
             }
         }
-        if (decrease) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
-        }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return true;
     }
 };
 
-class Nondecreasing : public Object {
+// Every pair of neighbours must satisfy Order, and all arguments must be numbers.
+template <class Order>
+class Chain : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool increase = true;
+    bool operator()(std::span<const Value> args) {
         for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i - 1]) || !Is<Number>(args[i])) {
+            if (!args[i - 1].IsNumber() || !args[i].IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            if (As<Number>(args[i])->GetValue() > As<Number>(args[i - 1])->GetValue()) {
-                increase = false;
-                break;
+            if (!Order{}(args[i - 1].GetNumber(), args[i].GetNumber())) {
+                return false;
             }
         }
-        if (increase) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
-        }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return true;
     }
 };
 
-class Nonincreasing : public Object {
+class Equal : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool decrease = true;
-        for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i - 1]) || !Is<Number>(args[i])) {
+    bool operator()(std::span<const Value> args) {
+        for (auto elem : args) {
+            if (!elem.IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            if (As<Number>(args[i])->GetValue() < As<Number>(args[i - 1])->GetValue()) {
-                decrease = false;
-                break;
+            if (elem.GetNumber() != args[0].GetNumber()) {
+                return false;
             }
         }
-        if (decrease) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
-        }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return true;
     }
 };
 
-class Add : public Object {
+using Increasing = Chain<std::greater<int64_t>>;
+using Decreasing = Chain<std::less<int64_t>>;
+using Nondecreasing = Chain<std::greater_equal<int64_t>>;
+using Nonincreasing = Chain<std::less_equal<int64_t>>;
+
+class Add : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         int64_t result = 0;
         for (auto elem : args) {
-            if (!Is<Number>(elem)) {
+            if (!elem.IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            result += As<Number>(elem)->GetValue();
+            result += elem.GetNumber();
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Sub : public Object {
+class Sub : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         if (args.empty()) {
             throw RuntimeError{"runtime-error"};
         }
-        if (!Is<Number>(args[0])) {
+        if (!args[0].IsNumber()) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t result = As<Number>(args[0])->GetValue();
+        int64_t result = args[0].GetNumber();
         for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i])) {
+            if (!args[i].IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            result -= As<Number>(args[i])->GetValue();
+            result -= args[i].GetNumber();
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Mul : public Object {
+class Mul : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         int64_t result = 1;
         for (auto elem : args) {
-            if (!Is<Number>(elem)) {
+            if (!elem.IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            result *= As<Number>(elem)->GetValue();
+            result *= elem.GetNumber();
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Div : public Object {
+class Div : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         if (args.empty()) {
             throw RuntimeError{"runtime-error"};
         }
-        if (!Is<Number>(args[0])) {
+        if (!args[0].IsNumber()) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t result = As<Number>(args[0])->GetValue();
+        int64_t result = args[0].GetNumber();
         for (size_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i])) {
+            if (!args[i].IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            result /= As<Number>(args[i])->GetValue();
+            result /= args[i].GetNumber();
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Max : public Object {
+class Max : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         if (args.empty()) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t result = -10e9;
+        if (!args[0].IsNumber()) {
+            throw RuntimeError{"runtime-error"};
+        }
+        int64_t result = args[0].GetNumber();
         for (auto elem : args) {
-            if (!Is<Number>(elem)) {
+            if (!elem.IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            if (As<Number>(elem)->GetValue() > result) {
-                result = As<Number>(elem)->GetValue();
+            if (elem.GetNumber() > result) {
+                result = elem.GetNumber();
             }
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Min : public Object {
+class Min : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         if (args.empty()) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t result = 10e9;
+        if (!args[0].IsNumber()) {
+            throw RuntimeError{"runtime-error"};
+        }
+        int64_t result = args[0].GetNumber();
         for (auto elem : args) {
-            if (!Is<Number>(elem)) {
+            if (!elem.IsNumber()) {
                 throw RuntimeError{"runtime-error"};
             }
-            if (As<Number>(elem)->GetValue() < result) {
-                result = As<Number>(elem)->GetValue();
+            if (elem.GetNumber() < result) {
+                result = elem.GetNumber();
             }
         }
-        return std::make_shared<Number>(Number{result});
+        return result;
     }
 };
 
-class Abs : public Object {
+class Abs : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    int64_t operator()(std::span<const Value> args) {
         if (args.size() != 1) {
             throw RuntimeError{"runtime-error"};
         }
-        if (!Is<Number>(args[0])) {
+        if (!args[0].IsNumber()) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t result = std::abs(As<Number>(args[0])->GetValue());
-        return std::make_shared<Number>(Number{result});
+        return std::abs(args[0].GetNumber());
     }
 };
 
-class IsBool : public Object {
+class IsBool : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
-        bool isbool = true;
+    bool operator()(std::span<const Value> args) {
         for (auto elem : args) {
-            if (!Is<Symbol>(elem)) {
-                isbool = false;
-                break;
-            } else if (As<Symbol>(elem)->GetName() != "#t" && As<Symbol>(elem)->GetName() != "#f") {
-                isbool = false;
-                break;
+            if (!elem.IsBool()) {
+                return false;
             }
         }
-        if (isbool) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
-        }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return true;
     }
 };
 
-class Not : public Object {
+class Not : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::vector<std::shared_ptr<Object>> args) {
+    bool operator()(std::span<const Value> args) {
         if (args.size() != 1) {
             throw RuntimeError{"runtime-error"};
         }
-        if (Is<Symbol>(args[0]) && As<Symbol>(args[0])->GetName() == "#f") {
-            return std::make_shared<Symbol>(Symbol{"#t"});
-        }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return args[0].IsFalse();
     }
 };
 
-class FunctionForList : public Object {
-public:
-    std::string Tostring(std::shared_ptr<Object> tree) {
-        std::string ans;
-        bool open = false;
-        while (tree != nullptr) {
-            if (Is<Symbol>(tree)) {
-                ans += As<Symbol>(tree)->GetName();
-                tree = nullptr;
-            } else if (Is<Number>(tree)) {
-                ans += std::to_string(As<Number>(tree)->GetValue());
-                tree = nullptr;
-            } else {
-                auto next = As<Cell>(tree)->GetFirst();
-                if (!As<Cell>(tree)->GetFirst() && !As<Cell>(tree)->GetSecond()) {
-                    ans += "()";
-                }
-                if (Is<Cell>(next)) {
-                    open = true;
-                    ans += "(";
-                    ans += Tostring(next);
-                    tree = As<Cell>(tree)->GetSecond();
-                } else {
-                    ans += Tostring(next);
-                    if (Is<Number>(next) && Is<Number>(As<Cell>(tree)->GetSecond())) {
-                        ans += " .";
-                    }
-                    tree = As<Cell>(tree)->GetSecond();
-                    if (tree != nullptr) {
-                        ans += " ";
-                    }
-                }
-            }
-        }
-        if (open) {
-            ans += ")";
-        }
-        return ans;
-    };
-    ~FunctionForList() = default;
-    virtual std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                               std::shared_ptr<Object> param = nullptr) = 0;
-};
+// The list builtins take evaluated arguments as well. A list is a chain of cells whose last
+// second is null, the empty list; results share structure with the arguments.
 
-class IsPair : public FunctionForList {
+class IsPair : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param = nullptr) override {
-        if (Is<Cell>(arg)) {
-            auto pair = (As<Cell>(arg))->GetSecond();
-            if (Is<Cell>(pair) && Is<Cell>(As<Cell>(pair)->GetFirst())) {
-                return std::make_shared<Symbol>(Symbol{"#t"});
-            }
-        } else {
-            RuntimeError{"runtime-error"};
+    bool operator()(std::span<const Value> args) {
+        if (args.size() != 1) {
+            throw RuntimeError{"runtime-error"};
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return AsCell(args[0]) != nullptr;
     }
 };
 
-class IsNull : public FunctionForList {
+class IsNull : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param = nullptr) override {
-        if (Is<Cell>(arg)) {
-            auto pair = (As<Cell>(arg))->GetSecond();
-            if (Is<Cell>(pair) && (As<Cell>(pair)->GetFirst() == nullptr)) {
-                return std::make_shared<Symbol>(Symbol{"#t"});
-            }
-        } else {
+    bool operator()(std::span<const Value> args) {
+        if (args.size() != 1) {
             throw RuntimeError{"runtime-error"};
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        return args[0].IsNil();
     }
 };
 
-class IsList : public FunctionForList {
+class IsList : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param = nullptr) override {
-        bool islist = true;
-        if (Is<Cell>(arg)) {
-            auto pair = As<Cell>(arg)->GetSecond();
-            auto list = As<Cell>(pair)->GetFirst();
-            while (list) {
-                if (Is<Cell>(list)) {
-                    list = As<Cell>(list)->GetSecond();
-                } else {
-                    islist = false;
-                    list = nullptr;
-                }
-            }
+    bool operator()(std::span<const Value> args) {
+        if (args.size() != 1) {
+            throw RuntimeError{"runtime-error"};
+        }
+        if (args[0].IsNil()) {
+            return true;
         }
-        if (islist) {
-            return std::make_shared<Symbol>(Symbol{"#t"});
+        const Cell* cell = AsCell(args[0]);
+        if (!cell) {
+            return false;
         }
-        return std::make_shared<Symbol>(Symbol{"#f"});
+        while (const Cell* next = cell->Next()) {
+            cell = next;
+        }
+        return !cell->GetSecond();
     }
 };
 
-class Car : public FunctionForList {
+class Car : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param = nullptr) override {
-        if (Is<Cell>(arg)) {
-            auto pair = (As<Cell>(arg))->GetSecond();
-            if (Is<Cell>(pair) && (As<Cell>(pair)->GetFirst() != nullptr)) {
-                auto next = As<Cell>(As<Cell>(pair)->GetFirst());
-                return std::make_shared<Symbol>(Symbol{Tostring(next->GetFirst())});
-            } else {
-                throw RuntimeError{"runtime-error"};
-            }
-        } else {
+    Value operator()(std::span<const Value> args) {
+        if (args.size() != 1 || !AsCell(args[0])) {
             throw RuntimeError{"runtime-error"};
         }
+        return ToValue(AsCell(args[0])->GetFirst());
     }
 };
 
-class Cdr : public FunctionForList {
+class Cdr : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param = nullptr) override {
-        if (Is<Cell>(arg)) {
-            auto pair = (As<Cell>(arg))->GetSecond();
-            if (Is<Cell>(pair) && (As<Cell>(pair)->GetFirst() != nullptr)) {
-                auto next = As<Cell>(As<Cell>(pair)->GetFirst());
-                if (Is<Cell>(next->GetSecond()) || next->GetSecond() == nullptr) {
-                    return std::make_shared<Symbol>(
-                        Symbol{"(" + Tostring(next->GetSecond()) + ")"});
-                }
-                return std::make_shared<Symbol>(Symbol{Tostring(next->GetSecond())});
-            } else {
-                throw RuntimeError{"runtime-error"};
-            }
-        } else {
+    Value operator()(std::span<const Value> args) {
+        if (args.size() != 1 || !AsCell(args[0])) {
             throw RuntimeError{"runtime-error"};
         }
+        return ToValue(AsCell(args[0])->GetSecond());
     }
 };
 
-class ListRef : public FunctionForList {
+class ListTail : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param) override {
-        if (!Is<Number>(param)) {
+    Value operator()(std::span<const Value> args) {
+        if (args.size() != 2 || !args[1].IsNumber() || args[1].GetNumber() < 0) {
             throw RuntimeError{"runtime-error"};
         }
-        int64_t count = As<Number>(param)->GetValue();
-        auto list = As<Cell>(As<Cell>(arg)->GetSecond())->GetFirst();
-        std::shared_ptr<Symbol> result = nullptr;
-        int64_t i = 0;
-        while (list && i <= count) {
-            if (Is<Cell>(list)) {
-                if (i == count) {
-                    result = std::make_shared<Symbol>(Symbol{Tostring(As<Cell>(list)->GetFirst())});
-                }
-                list = As<Cell>(list)->GetSecond();
-                i += 1;
-            } else {
-                if (i == count) {
-                    result = std::make_shared<Symbol>(Symbol{Tostring(list)});
-                }
-                result = std::make_shared<Symbol>(Symbol{Tostring(list)});
-                i += 1;
-                list = nullptr;
-            }
+        int64_t count = args[1].GetNumber();
+        if (count == 0) {
+            return args[0];
         }
-        if (i - 1 == count) {
-            return result;
-        } else {
+        const Cell* cell = AsCell(args[0]);
+        for (int64_t i = 1; cell && i < count; ++i) {
+            cell = cell->Next();
+        }
+        if (!cell) {
             throw RuntimeError{"runtime-error"};
         }
+        return ToValue(cell->GetSecond());
     }
 };
 
-class ListTail : public FunctionForList {
+class ListRef : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> arg,
-                                       std::shared_ptr<Object> param) override {
-        if (!Is<Number>(param)) {
-            throw RuntimeError{"runtime-error"};
-        }
-        int64_t count = As<Number>(param)->GetValue();
-        auto list = As<Cell>(As<Cell>(arg)->GetSecond())->GetFirst();
-        std::shared_ptr<Symbol> result = nullptr;
-        int64_t i = 1;
-        while (list && i <= count) {
-            if (Is<Cell>(list)) {
-                if (i == count) {
-                    result = std::make_shared<Symbol>(
-                        Symbol{"(" + Tostring(As<Cell>(list)->GetSecond()) + ")"});
-                }
-                list = As<Cell>(list)->GetSecond();
-                i += 1;
-            } else {
-                if (i == count) {
-                    result = std::make_shared<Symbol>(Symbol{"(" + Tostring(list) + ")"});
-                }
-                i += 1;
-                list = nullptr;
-            }
-        }
-        if (i - 1 == count) {
-            return result;
-        } else {
+    Value operator()(std::span<const Value> args) {
+        Value tail = ListTail{}(args);
+        if (!AsCell(tail)) {
             throw RuntimeError{"runtime-error"};
         }
+        return ToValue(AsCell(tail)->GetFirst());
     }
-};
\ No newline at end of file
+};
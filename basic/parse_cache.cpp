@@ -0,0 +1,66 @@
+#include "parse_cache.h"
+
+#include <mutex>
+
+ParseCache::ParseCache(size_t capacity)
+    : capacity_(capacity ? capacity : 1), entries_(new Entry[capacity_]) {
+    by_source_.reserve(capacity_);
+}
+
+bool ParseCache::Find(std::string_view source, Ref<Object>* tree) {
+    {
+        std::shared_lock lock{mutex_};
+        auto it = by_source_.find(source);
+        if (it != by_source_.end()) {
+            it->second->referenced.store(true, std::memory_order_relaxed);
+            *tree = it->second->tree;
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void ParseCache::Insert(std::string_view source, Ref<Object> tree) {
+    ShareAcrossThreads(tree);
+    // The evicted tree is freed after the lock is released; tearing down a big one takes a
+    // while.
+    Ref<Object> evicted;
+    std::unique_lock lock{mutex_};
+    if (by_source_.count(source)) {
+        return;
+    }
+    Entry* entry;
+    if (size_ < capacity_) {
+        entry = &entries_[size_++];
+    } else {
+        while (entries_[hand_].referenced.exchange(false, std::memory_order_relaxed)) {
+            hand_ = (hand_ + 1) % capacity_;
+        }
+        entry = &entries_[hand_];
+        hand_ = (hand_ + 1) % capacity_;
+        by_source_.erase(entry->source);
+        evicted = std::move(entry->tree);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    entry->source.assign(source);
+    entry->tree = std::move(tree);
+    entry->referenced.store(false, std::memory_order_relaxed);
+    by_source_.emplace(entry->source, entry);
+    lock.unlock();
+}
+
+ParseCacheStats ParseCache::Stats() const {
+    ParseCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    std::shared_lock lock{mutex_};
+    stats.size = by_source_.size();
+    return stats;
+}
+
+size_t ParseCache::Capacity() const {
+    return capacity_;
+}
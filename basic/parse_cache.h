@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "object.h"
+
+struct ParseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+};
+
+// Bounded map from expression text to its parse tree, shared by any number of interpreters and
+// threads. Eviction is CLOCK: a hit only sets the entry's reference bit, so lookups run under a
+// shared lock, and the sweep evicts the first entry not referenced since its last pass.
+//
+// Cached trees are shared by everyone who looks them up and must be treated as immutable.
+class ParseCache {
+public:
+    explicit ParseCache(size_t capacity = 1024);
+
+    ParseCache(const ParseCache&) = delete;
+    ParseCache& operator=(const ParseCache&) = delete;
+
+    // Counts a hit or a miss. The tree may legitimately be null, e.g. for "()".
+    bool Find(std::string_view source, Ref<Object>* tree);
+
+    // Adds a tree that lives on the heap and marks it with ShareAcrossThreads(). Keeps the
+    // existing entry if the source is cached already, e.g. because another thread parsed it at
+    // the same time.
+    void Insert(std::string_view source, Ref<Object> tree);
+
+    ParseCacheStats Stats() const;
+
+    size_t Capacity() const;
+
+private:
+    struct Entry {
+        std::string source;
+        Ref<Object> tree;
+        std::atomic<bool> referenced{false};
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Entry[]> entries_;
+    size_t size_ = 0;
+    size_t hand_ = 0;
+
+    mutable std::shared_mutex mutex_;
+    // Keys are views into the sources owned by entries_.
+    std::unordered_map<std::string_view, Entry*> by_source_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
@@ -1,114 +1,123 @@
 #include <parser.h>
 #include "error.h"
+#include "reader.h"
 
-bool TokenIsNumber(Token& token) {
-    bool isnumber = true;
-    try {
-        std::get<ConstantToken>(token);
-    } catch (...) {
-        isnumber = false;
+namespace {
+
+// Builds trees. A list is built once it is complete: hash consing needs it from the right, and
+// otherwise its cells are laid out as one run. Until then the elements of the open lists (and
+// a dotted tail) wait on items_, each list's from the index on lists_ on.
+class TreeBuilder {
+public:
+    using Datum = Ref<Object>;
+
+    explicit TreeBuilder(HashConsTable* cons) : cons_(cons) {
     }
-    return isnumber;
-}
 
-bool TokenIsSymbol(Token& token) {
-    bool issymbol = true;
-    try {
-        std::get<SymbolToken>(token);
-    } catch (...) {
-        issymbol = false;
+    Ref<Object> OnNumber(int64_t value) {
+        return cons_ ? cons_->MakeNumber(value) : NumberObject(value);
     }
-    return issymbol;
-}
 
-bool TokenIsQuote(Token& token) {
-    bool isquote = true;
-    try {
-        std::get<QuoteToken>(token);
-    } catch (...) {
-        isquote = false;
+    Ref<Object> OnSymbol(std::string_view name) {
+        return cons_ ? cons_->MakeSymbol(name) : SymbolObject(name);
     }
-    return isquote;
-}
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("syntax error");
+    void OnBeginList() {
+        lists_.push_back(items_.size());
     }
-    Token token = tokenizer->GetToken();
-    if (token == Token{BracketToken::OPEN}) {
-        tokenizer->Next();
-        return ReadList(tokenizer);
-    } else if (TokenIsNumber(token)) {
-        tokenizer->Next();
-        return std::make_shared<Number>(Number{std::get<ConstantToken>(token).value});
-    } else if (TokenIsSymbol(token)) {
-        tokenizer->Next();
-        return std::make_shared<Symbol>(Symbol{std::get<SymbolToken>(token).name});
-    } else if (token == Token{BracketToken::CLOSE}) {
-        tokenizer->Next();
-        return std::make_shared<CloseBracket>();
-    } else if (token == Token{DotToken{}}) {
-        tokenizer->Next();
-        return Read(tokenizer);
-    } else if (TokenIsQuote(token)) {
-        tokenizer->Next();
-        if (tokenizer->IsEnd()) {
-            throw SyntaxError("syntax error");
+
+    void OnDot() {
+    }
+
+    void OnElement(Ref<Object> datum) {
+        items_.push_back(std::move(datum));
+    }
+
+    Ref<Object> OnEndList(bool dotted) {
+        size_t begin = lists_.back();
+        lists_.pop_back();
+        Ref<Object> list;
+        if (dotted) {
+            list = std::move(items_.back());
+            items_.pop_back();
         }
-        token = tokenizer->GetToken();
-        if (!TokenIsNumber(token) && !TokenIsSymbol(token) &&
-            (token != Token{BracketToken::OPEN})) {
-            throw SyntaxError("syntax error");
+        if (cons_) {
+            for (size_t i = items_.size(); i > begin; --i) {
+                list = cons_->MakeCell(items_[i - 1], list);
+            }
+        } else {
+            Ref<Object>* elements = items_.data() + begin;
+            auto element = [elements](size_t i) { return std::move(elements[i]); };
+            list = MakeListObject(items_.size() - begin, element, std::move(list));
         }
-        auto quote = Read(tokenizer);
-        auto list = std::make_shared<Cell>(Cell());
-        auto symbol = std::make_shared<Symbol>(Symbol{"quote"});
-        list->AppendFirst(symbol);
-        auto list_of_quote = std::make_shared<Cell>(Cell());
-        list_of_quote->AppendSecond(nullptr);
-        list_of_quote->AppendFirst(quote);
-        list->AppendSecond(list_of_quote);
+        items_.resize(begin);
         return list;
-    } else {
-        throw SyntaxError("syntax error");
     }
-}
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-    auto root = std::make_shared<Cell>(Cell());
-    auto list = root;
-    if (tokenizer->GetToken() == Token{DotToken{}}) {
-        throw SyntaxError("syntax error");
+    void OnQuote() {
     }
-    auto object = Read(tokenizer);
-    if (Is<CloseBracket>(object)) {
-        return nullptr;
-    }
-    while (!Is<CloseBracket>(object)) {
-        if (tokenizer->GetToken() == Token{DotToken{}}) {
-            if (list->GetFirst() && object) {
-                throw SyntaxError("syntax error");
-            }
-            list->AppendFirst(object);
-            object = Read(tokenizer);
-            if (Is<CloseBracket>(object)) {
-                throw SyntaxError("syntax error");
-            }
-            list->AppendSecond(object);
-            object = Read(tokenizer);
-        } else {
-            if (list->GetFirst() && object) {
-                throw SyntaxError("syntax error");
-            }
-            list->AppendFirst(object);
-            if (tokenizer->GetToken() != Token{BracketToken::CLOSE}) {
-                auto next = std::make_shared<Cell>(Cell());
-                list->AppendSecond(next);
-                list = next;
-            }
-            object = Read(tokenizer);
+
+    // (quote datum)
+    Ref<Object> OnEndQuote(Ref<Object> datum) {
+        if (cons_) {
+            return cons_->MakeCell(cons_->MakeSymbol(BuiltinSymbol::QUOTE),
+                                   cons_->MakeCell(datum, nullptr));
         }
+        Ref<Object> quote = MakeObject<Symbol>(BuiltinSymbol::QUOTE);
+        return MakeListObject(
+            2, [&](size_t i) { return std::move(i == 0 ? quote : datum); }, nullptr);
+    }
+
+private:
+    HashConsTable* cons_;
+    std::vector<size_t> lists_;
+    std::vector<Ref<Object>> items_;
+};
+
+template <class Source>
+Expected<Ref<Object>> RunReader(Source* source, bool list, const ReaderOptions& options) {
+    TreeBuilder builder{options.hash_cons};
+    Reader<Source, TreeBuilder> reader{source, &builder, options};
+    Ref<Object> object;
+    if (!reader.Read(&object, list)) {
+        return reader.Error();
+    }
+    return object;
+}
+
+}  // namespace
+
+Ref<Object> Read(Tokenizer* tokenizer, const ReaderOptions& options) {
+    TokenizerSource source{tokenizer};
+    return RunReader(&source, false, options).ValueOrThrow();
+}
+
+Ref<Object> ReadList(Tokenizer* tokenizer, const ReaderOptions& options) {
+    TokenizerSource source{tokenizer};
+    return RunReader(&source, true, options).ValueOrThrow();
+}
+
+Ref<Object> Read(const TokenBuffer& tokens, size_t* pos, const ReaderOptions& options) {
+    return TryRead(tokens, pos, options).ValueOrThrow();
+}
+
+Expected<Ref<Object>> TryRead(const TokenBuffer& tokens, size_t* pos,
+                              const ReaderOptions& options) {
+    BufferSource source{tokens, *pos};
+    auto result = RunReader(&source, false, options);
+    *pos = source.Pos();
+    return result;
+}
+
+Expected<Ref<Object>> TryReadFull(std::string_view str, const ReaderOptions& options) {
+    auto tokens = TryTokenize(str);
+    if (!tokens) {
+        return tokens.Error();
     }
-    return root;
-}
\ No newline at end of file
+    size_t pos = 0;
+    auto result = TryRead(tokens.Value(), &pos, options);
+    if (result && pos != tokens.Value().Size()) {
+        return ParseError{"unexpected input after the expression"};
+    }
+    return result;
+}
@@ -2,9 +2,29 @@
 
 #include <memory>
 
+#include "hash_cons.h"
 #include "object.h"
 #include <tokenizer.h>
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+struct ReaderOptions {
+    // Lists and quotes nested deeper than this are rejected as a syntax error.
+    size_t max_depth = 10000;
+    // When set, trees are built through this table: structurally equal subtrees, within one
+    // read and across reads, are one shared object. Such trees must not be modified.
+    HashConsTable* hash_cons = nullptr;
+};
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
\ No newline at end of file
+Ref<Object> Read(Tokenizer* tokenizer, const ReaderOptions& options = {});
+
+Ref<Object> ReadList(Tokenizer* tokenizer, const ReaderOptions& options = {});
+
+// Reads one expression from bulk-tokenized input, starting at token `*pos`, and moves `*pos`
+// past it.
+Ref<Object> Read(const TokenBuffer& tokens, size_t* pos, const ReaderOptions& options = {});
+
+// Non-throwing variants: malformed input comes back as a ParseError.
+Expected<Ref<Object>> TryRead(const TokenBuffer& tokens, size_t* pos,
+                              const ReaderOptions& options = {});
+
+// Tokenizes `str` and reads exactly one expression from it.
+Expected<Ref<Object>> TryReadFull(std::string_view str, const ReaderOptions& options = {});
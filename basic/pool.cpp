@@ -0,0 +1,211 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+SlabPool::SlabPool(PoolRegistry* registry, size_t slot_size)
+    : registry_(registry), slot_size_(slot_size) {
+}
+
+void SlabPool::NextSlab() {
+    CollectRemote();
+    if (free_) {
+        return;
+    }
+    // The current slab is used up; it is refiled once its slots are freed.
+    Slab* slab;
+    if (!partial_.empty()) {
+        slab = partial_.back();
+        partial_.pop_back();
+        slab->partial = false;
+        free_ = std::exchange(slab->free, nullptr);
+        bump_ = end_ = nullptr;
+    } else {
+        slab = registry_->NewSlab(this);
+        bump_ = registry_->FirstSlot(slab);
+        end_ = bump_ + registry_->slots_per_slab_ * slot_size_;
+    }
+    current_ = slab;
+}
+
+void SlabPool::CollectRemote() {
+    Slab* slab = remote_slabs_.exchange(nullptr, std::memory_order_acquire);
+    while (slab) {
+        // Read before the remote list is emptied: from then on, a thread freeing into the slab
+        // queues it again and overwrites the link.
+        Slab* next = slab->next_remote;
+        FreeSlot* slots = slab->remote.exchange(nullptr, std::memory_order_acq_rel);
+        FreeSlot*& free = slab == current_ ? free_ : slab->free;
+        while (slots) {
+            FreeSlot* slot = slots;
+            slots = slot->next;
+            slot->next = free;
+            free = slot;
+            --slab->live;
+        }
+        if (slab != current_) {
+            Refile(slab);
+        }
+        slab = next;
+    }
+}
+
+void SlabPool::Refile(Slab* slab) {
+    if (slab->live == 0) {
+        if (slab->partial) {
+            partial_.erase(std::find(partial_.begin(), partial_.end(), slab));
+        }
+        registry_->RetireSlab(slab);
+    } else if (!slab->partial) {
+        slab->partial = true;
+        partial_.push_back(slab);
+    }
+}
+
+void SlabPool::FreeForeign(Slab* slab, void* slot) {
+    if (slab->owner) {
+        slab->owner->FreeRemote(slab, slot);
+    } else {
+        registry_->FreeOrphan(slot);
+    }
+}
+
+void SlabPool::FreeRemote(Slab* slab, void* slot) {
+    auto free = static_cast<FreeSlot*>(slot);
+    FreeSlot* head = slab->remote.load(std::memory_order_relaxed);
+    do {
+        free->next = head;
+    } while (!slab->remote.compare_exchange_weak(head, free, std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed));
+    if (head) {
+        // Queued already by whoever found the list empty.
+        return;
+    }
+    Slab* queued = remote_slabs_.load(std::memory_order_relaxed);
+    do {
+        slab->next_remote = queued;
+    } while (!remote_slabs_.compare_exchange_weak(queued, slab, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+}
+
+PoolRegistry::PoolRegistry(size_t object_size, size_t alignment)
+    : object_size_(object_size),
+      slot_size_((std::max(object_size, sizeof(void*)) + alignment - 1) / alignment * alignment),
+      first_slot_((sizeof(Slab) + slot_size_ - 1) / slot_size_ * slot_size_),
+      slots_per_slab_((SlabPool::kSlabBytes - first_slot_) / slot_size_) {
+}
+
+SlabPool* PoolRegistry::Acquire() {
+    std::unique_lock lock{mutex_};
+    if (idle_.empty()) {
+        pools_.push_back(std::unique_ptr<SlabPool>(new SlabPool(this, slot_size_)));
+        return pools_.back().get();
+    }
+    SlabPool* pool = idle_.back();
+    idle_.pop_back();
+    lock.unlock();
+    // Whatever was freed while the pool was idle; slabs that emptied meanwhile go back here
+    // rather than waiting for the new thread to use up the current one.
+    pool->CollectRemote();
+    return pool;
+}
+
+void PoolRegistry::Release(SlabPool* pool) {
+    std::lock_guard lock{mutex_};
+    idle_.push_back(pool);
+}
+
+void* PoolRegistry::AllocateOrphan() {
+    std::lock_guard lock{mutex_};
+    ++orphan_live_;
+    if (orphans_) {
+        void* slot = orphans_;
+        orphans_ = orphans_->next;
+        return slot;
+    }
+    if (orphan_end_ - orphan_bump_ < static_cast<ptrdiff_t>(slot_size_)) {
+        orphan_bump_ = FirstSlot(NewSlabLocked(nullptr));
+        orphan_end_ = orphan_bump_ + slots_per_slab_ * slot_size_;
+    }
+    void* slot = orphan_bump_;
+    orphan_bump_ += slot_size_;
+    return slot;
+}
+
+void PoolRegistry::Free(void* slot) {
+    Slab* slab = SlabPool::SlabOf(slot);
+    std::unique_lock lock{mutex_};
+    --orphan_live_;
+    if (!slab->owner) {
+        auto free = static_cast<SlabPool::FreeSlot*>(slot);
+        free->next = orphans_;
+        orphans_ = free;
+        return;
+    }
+    lock.unlock();
+    slab->owner->FreeRemote(slab, slot);
+}
+
+void PoolRegistry::FreeOrphan(void* slot) {
+    std::lock_guard lock{mutex_};
+    auto free = static_cast<SlabPool::FreeSlot*>(slot);
+    free->next = orphans_;
+    orphans_ = free;
+}
+
+PoolStats PoolRegistry::Stats() const {
+    std::lock_guard lock{mutex_};
+    PoolStats stats;
+    stats.object_size = object_size_;
+    stats.slabs = slabs_.size();
+    stats.slots = slabs_.size() * slots_per_slab_;
+    int64_t live = orphan_live_;
+    for (const auto& pool : pools_) {
+        live += pool->live_.load(std::memory_order_relaxed);
+    }
+    stats.live = live;
+    return stats;
+}
+
+void PoolRegistry::SlabDeleter::operator()(std::byte* slab) const {
+    ::operator delete(slab, std::align_val_t{SlabPool::kSlabBytes});
+}
+
+PoolRegistry::Slab* PoolRegistry::NewSlab(SlabPool* owner) {
+    std::unique_lock lock{mutex_};
+    if (empty_.empty() && !idle_.empty()) {
+        // Slots freed into an idle pool wait there until a thread takes it over. Before more
+        // memory is allocated, the idle pools give back the slabs that emptied meanwhile.
+        std::vector<SlabPool*> idle = std::move(idle_);
+        idle_.clear();
+        lock.unlock();
+        for (SlabPool* pool : idle) {
+            pool->CollectRemote();
+        }
+        lock.lock();
+        idle_.insert(idle_.end(), idle.begin(), idle.end());
+    }
+    return NewSlabLocked(owner);
+}
+
+void PoolRegistry::RetireSlab(Slab* slab) {
+    slab->~Slab();
+    std::lock_guard lock{mutex_};
+    empty_.push_back(slab);
+}
+
+PoolRegistry::Slab* PoolRegistry::NewSlabLocked(SlabPool* owner) {
+    void* memory;
+    if (!empty_.empty()) {
+        memory = empty_.back();
+        empty_.pop_back();
+    } else {
+        // Aligned to its size, see SlabPool::SlabOf(). The slots are handed out uninitialized.
+        memory = ::operator new(SlabPool::kSlabBytes, std::align_val_t{SlabPool::kSlabBytes});
+        slabs_.emplace_back(static_cast<std::byte*>(memory));
+    }
+    Slab* slab = ::new (memory) Slab();
+    slab->owner = owner;
+    return slab;
+}
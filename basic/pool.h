@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct PoolStats {
+    size_t object_size = 0;
+    size_t slabs = 0;
+    // Slots in all slabs, free or not.
+    size_t slots = 0;
+    size_t live = 0;
+
+    // Fraction of the slots that hold a live object.
+    double Occupancy() const {
+        return slots ? static_cast<double>(live) / slots : 0;
+    }
+};
+
+class PoolRegistry;
+
+// Free-list allocator for objects of one size, owned by one thread. Allocation pops the free
+// list or bumps a pointer through the current slab; nothing is locked except to change slabs.
+// Every slab belongs to one pool. A slot freed on another thread is pushed onto its slab's
+// remote list, without a lock, and the owner takes it back once the current slab is used up.
+// A slab whose slots are all free again goes back to the registry for any pool to reuse.
+class SlabPool {
+public:
+    static constexpr size_t kSlabBytes = 64 * 1024;
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    void* Allocate() {
+        if (!free_ && end_ - bump_ < static_cast<ptrdiff_t>(slot_size_)) {
+            NextSlab();
+        }
+        AddLive(1);
+        ++current_->live;
+        if (free_) {
+            void* slot = free_;
+            free_ = free_->next;
+            return slot;
+        }
+        void* slot = bump_;
+        bump_ += slot_size_;
+        return slot;
+    }
+
+    // Up to `count` adjacent slots, at least one, for objects that are walked in address order.
+    // They come from the free list if its leading slots make up the whole run, otherwise from
+    // the current slab while it lasts, and otherwise they are as many of the leading free
+    // slots as happen to be adjacent. Each slot is freed on its own.
+    void* AllocateRun(size_t count, size_t* allocated) {
+        if (!free_ && end_ - bump_ < static_cast<ptrdiff_t>(slot_size_)) {
+            NextSlab();
+        }
+        void* run = nullptr;
+        if (free_) {
+            // A freed list leaves its slots on the free list in either address order.
+            std::byte* low = reinterpret_cast<std::byte*>(free_);
+            size_t length = 1;
+            FreeSlot* rest = free_->next;
+            while (length < count && rest) {
+                auto next = reinterpret_cast<std::byte*>(rest);
+                if (next == low - slot_size_) {
+                    low = next;
+                } else if (next != low + length * slot_size_) {
+                    break;
+                }
+                rest = rest->next;
+                ++length;
+            }
+            if (length == count || end_ - bump_ < static_cast<ptrdiff_t>(slot_size_)) {
+                free_ = rest;
+                *allocated = length;
+                run = low;
+            }
+        }
+        if (!run) {
+            size_t available = static_cast<size_t>(end_ - bump_) / slot_size_;
+            *allocated = std::min(count, available);
+            run = bump_;
+            bump_ += *allocated * slot_size_;
+        }
+        AddLive(static_cast<int64_t>(*allocated));
+        current_->live += *allocated;
+        return run;
+    }
+
+    void Free(void* slot) {
+        AddLive(-1);
+        Slab* slab = SlabOf(slot);
+        if (slab->owner != this) {
+            FreeForeign(slab, slot);
+            return;
+        }
+        auto free = static_cast<FreeSlot*>(slot);
+        if (slab == current_) {
+            free->next = free_;
+            free_ = free;
+            --slab->live;
+            return;
+        }
+        free->next = slab->free;
+        slab->free = free;
+        --slab->live;
+        Refile(slab);
+    }
+
+private:
+    friend class PoolRegistry;
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    // Sits at the start of every slab, which is aligned to kSlabBytes, so the slab of a slot
+    // is found by masking its address.
+    struct Slab {
+        // Null for the slabs of the registry's orphan slots.
+        SlabPool* owner = nullptr;
+        // Slots freed by the owner. Those of the current slab are on the pool's free_ instead.
+        FreeSlot* free = nullptr;
+        // Slots freed on other threads, and the link in the owner's remote_slabs_ while there
+        // are any.
+        std::atomic<FreeSlot*> remote{nullptr};
+        Slab* next_remote = nullptr;
+        // Slots handed out and not yet given back to the owner, remote ones included.
+        size_t live = 0;
+        // Whether the slab is on the owner's partial_.
+        bool partial = false;
+    };
+
+    static Slab* SlabOf(void* slot) {
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(slot) & ~(kSlabBytes - 1));
+    }
+
+    SlabPool(PoolRegistry* registry, size_t slot_size);
+
+    // Only this pool's thread writes the counter; the registry reads it for stats.
+    void AddLive(int64_t delta) {
+        live_.store(live_.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    // Makes slots available, from remote frees, a partially used slab or a new one.
+    void NextSlab();
+
+    // Takes the slots freed on other threads back.
+    void CollectRemote();
+
+    // Puts a slab that is not the current one where its free slots are found: on partial_, or
+    // back to the registry once all of them are free.
+    void Refile(Slab* slab);
+
+    // A slot of another pool's slab, or of an orphan slab.
+    void FreeForeign(Slab* slab, void* slot);
+
+    // Called on the freeing thread, for a slab of this pool.
+    void FreeRemote(Slab* slab, void* slot);
+
+    PoolRegistry* registry_;
+    const size_t slot_size_;
+    Slab* current_ = nullptr;
+    FreeSlot* free_ = nullptr;
+    std::byte* bump_ = nullptr;
+    std::byte* end_ = nullptr;
+    // Slabs with free slots, other than the current one.
+    std::vector<Slab*> partial_;
+    // Slabs with slots on their remote list, linked through next_remote.
+    std::atomic<Slab*> remote_slabs_{nullptr};
+    // Counts this thread's allocations and frees, wherever the slots live, so it may go
+    // negative on a thread that frees more than it allocates.
+    std::atomic<int64_t> live_{0};
+};
+
+// The slab pools of one object size, one per thread. Slabs are kept for reuse rather than
+// returned to the system. A pool whose thread exits is handed, with its slabs, to the next
+// thread that needs one. Objects the exiting thread allocates after that, from later
+// thread_local destructors, come from orphan slabs of the registry, under its lock.
+class PoolRegistry {
+public:
+    PoolRegistry(size_t object_size, size_t alignment);
+
+    PoolRegistry(const PoolRegistry&) = delete;
+    PoolRegistry& operator=(const PoolRegistry&) = delete;
+
+    SlabPool* Acquire();
+
+    // The calling thread must not touch `pool` afterwards.
+    void Release(SlabPool* pool);
+
+    // For a thread that has released its pool.
+    void* AllocateOrphan();
+    void Free(void* slot);
+
+    PoolStats Stats() const;
+
+private:
+    friend class SlabPool;
+
+    using Slab = SlabPool::Slab;
+
+    struct SlabDeleter {
+        void operator()(std::byte* slab) const;
+    };
+
+    // An empty slab for `owner`, reused if there is one.
+    Slab* NewSlab(SlabPool* owner);
+    void RetireSlab(Slab* slab);
+
+    // With mutex_ held.
+    Slab* NewSlabLocked(SlabPool* owner);
+
+    // For a thread that still has its pool, which counted the slot as freed already.
+    void FreeOrphan(void* slot);
+
+    std::byte* FirstSlot(Slab* slab) const {
+        return reinterpret_cast<std::byte*>(slab) + first_slot_;
+    }
+
+    const size_t object_size_;
+    const size_t slot_size_;
+    // Offset of the first slot of a slab, past its header.
+    const size_t first_slot_;
+    const size_t slots_per_slab_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<SlabPool>> pools_;
+    std::vector<SlabPool*> idle_;
+    std::vector<std::unique_ptr<std::byte, SlabDeleter>> slabs_;
+    std::vector<Slab*> empty_;
+    SlabPool::FreeSlot* orphans_ = nullptr;
+    std::byte* orphan_bump_ = nullptr;
+    std::byte* orphan_end_ = nullptr;
+    int64_t orphan_live_ = 0;
+};
+
+// Per-type pools: objects of one type are packed together in their own slabs.
+template <class T>
+class ObjectPool {
+public:
+    static void* Allocate() {
+        if (SlabPool* pool = Local()) {
+            return pool->Allocate();
+        }
+        return Registry().AllocateOrphan();
+    }
+
+    static void* AllocateRun(size_t count, size_t* allocated) {
+        if (SlabPool* pool = Local()) {
+            return pool->AllocateRun(count, allocated);
+        }
+        *allocated = 1;
+        return Registry().AllocateOrphan();
+    }
+
+    static void Free(void* object) {
+        if (SlabPool* pool = Local()) {
+            pool->Free(object);
+        } else {
+            Registry().Free(object);
+        }
+    }
+
+    static PoolStats Stats() {
+        return Registry().Stats();
+    }
+
+private:
+    // Never destroyed, so that objects freed during process exit still have a pool to go to.
+    static PoolRegistry& Registry() {
+        static PoolRegistry* registry = new PoolRegistry(sizeof(T), alignof(T));
+        return *registry;
+    }
+
+    // Gives the thread's pool back to the registry when the thread exits.
+    struct ThreadExit {
+        ~ThreadExit() {
+            Registry().Release(pool_);
+            pool_ = nullptr;
+            exited_ = true;
+        }
+    };
+
+    // Null once the pool went back to the registry at thread exit. Both variables are trivially
+    // destructible, so they stay usable from the thread's later thread_local destructors.
+    static SlabPool* Local() {
+        if (!pool_ && !exited_) {
+            pool_ = Registry().Acquire();
+            thread_local ThreadExit exit;
+        }
+        return pool_;
+    }
+
+    static inline thread_local SlabPool* pool_ = nullptr;
+    static inline thread_local bool exited_ = false;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "error.h"
+#include "parser.h"
+#include "token_source.h"
+
+// The grammar of the readers, shared by the tree reader (parser.cpp) and the event reader
+// (event_reader.cpp). What a datum turns into is up to the Builder, which is told about the
+// input as it is accepted:
+//
+//   using Datum = ...;                // what a finished datum is
+//   Datum OnNumber(int64_t value);
+//   Datum OnSymbol(std::string_view name);   // `name` may not survive the call
+//   void OnBeginList();
+//   void OnDot();
+//   void OnElement(Datum datum);      // the next element, or the tail after OnDot()
+//   Datum OnEndList(bool dotted);     // the elements since the matching OnBeginList()
+//   void OnQuote();
+//   Datum OnEndQuote(Datum datum);    // the datum after the matching OnQuote()
+//
+// Syntax errors are returned, not thrown: Read() reports failure through its bool result and
+// the reason is kept in error_.
+//
+// The reader is iterative. Every open list and pending quote is a frame on stack_, a heap
+// vector, so nesting depth costs no C++ stack and is bounded only by options_.max_depth.
+template <class Source, class Builder>
+class Reader {
+public:
+    using Datum = typename Builder::Datum;
+
+    Reader(Source* source, Builder* builder, const ReaderOptions& options)
+        : source_(source), builder_(builder), options_(options) {
+    }
+
+    // Reads one datum. With `in_list` the opening bracket is taken as already consumed.
+    bool Read(Datum* out, bool in_list = false) {
+        if (in_list && !BeginList()) {
+            return false;
+        }
+        while (true) {
+            SourceKind kind = source_->Kind();
+            Datum value;
+
+            if (!stack_.empty() && stack_.back().type != Frame::QUOTE) {
+                Frame& frame = stack_.back();
+                if (kind == SourceKind::CLOSE) {
+                    if (frame.type == Frame::AFTER_DOT) {
+                        return Fail("expected a datum after '.'");
+                    }
+                    source_->Next();
+                    bool dotted = frame.type == Frame::DOTTED;
+                    stack_.pop_back();
+                    value = builder_->OnEndList(dotted);
+                    if (Complete(&value)) {
+                        *out = std::move(value);
+                        return true;
+                    }
+                    continue;
+                }
+                if (frame.type == Frame::DOTTED) {
+                    return Fail("more than one datum after '.'");
+                }
+                if (kind == SourceKind::DOT) {
+                    if (frame.empty) {
+                        return Fail("'.' at the start of a list");
+                    }
+                    if (frame.type == Frame::AFTER_DOT) {
+                        return Fail("expected a datum after '.'");
+                    }
+                    frame.type = Frame::AFTER_DOT;
+                    source_->Next();
+                    builder_->OnDot();
+                    continue;
+                }
+            }
+
+            switch (kind) {
+                case SourceKind::OPEN:
+                    source_->Next();
+                    if (!BeginList()) {
+                        return false;
+                    }
+                    continue;
+                case SourceKind::QUOTE: {
+                    source_->Next();
+                    auto next = source_->Kind();
+                    if (next != SourceKind::CONSTANT && next != SourceKind::SYMBOL &&
+                        next != SourceKind::OPEN) {
+                        return Fail("quote must be followed by a datum");
+                    }
+                    if (!Push(Frame::QUOTE)) {
+                        return false;
+                    }
+                    builder_->OnQuote();
+                    continue;
+                }
+                case SourceKind::CONSTANT:
+                    value = builder_->OnNumber(source_->Value());
+                    break;
+                case SourceKind::SYMBOL:
+                    // The token text may not survive Next(), so the builder sees it first.
+                    value = builder_->OnSymbol(source_->Text());
+                    break;
+                case SourceKind::CLOSE:
+                    return Fail("unexpected ')'");
+                case SourceKind::DOT:
+                    return Fail("unexpected '.'");
+                default:
+                    return Fail("unexpected end of input");
+            }
+            source_->Next();
+            if (Complete(&value)) {
+                *out = std::move(value);
+                return true;
+            }
+        }
+    }
+
+    ParseError Error() const {
+        return ParseError{error_};
+    }
+
+private:
+    struct Frame {
+        // LIST collects elements, AFTER_DOT waits for the tail datum, DOTTED has it and only
+        // accepts ')'. QUOTE applies to the next datum.
+        enum Type : uint8_t { LIST, AFTER_DOT, DOTTED, QUOTE } type;
+        bool empty = true;
+    };
+
+    bool Push(typename Frame::Type type) {
+        if (stack_.size() >= options_.max_depth) {
+            return Fail("nesting too deep");
+        }
+        stack_.push_back(Frame{type});
+        return true;
+    }
+
+    bool BeginList() {
+        if (!Push(Frame::LIST)) {
+            return false;
+        }
+        builder_->OnBeginList();
+        return true;
+    }
+
+    // Hands a finished datum to the enclosing frame. Returns true if it is the top-level
+    // datum, i.e. reading is done.
+    bool Complete(Datum* value) {
+        while (!stack_.empty() && stack_.back().type == Frame::QUOTE) {
+            stack_.pop_back();
+            *value = builder_->OnEndQuote(std::move(*value));
+        }
+        if (stack_.empty()) {
+            return true;
+        }
+        Frame& frame = stack_.back();
+        builder_->OnElement(std::move(*value));
+        if (frame.type == Frame::AFTER_DOT) {
+            frame.type = Frame::DOTTED;
+        }
+        frame.empty = false;
+        return false;
+    }
+
+    bool Fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    Source* source_;
+    Builder* builder_;
+    const ReaderOptions& options_;
+    std::vector<Frame> stack_;
+    const char* error_ = nullptr;
+};
@@ -1,258 +1,441 @@
 #include "scheme.h"
 
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+enum GcBit : uint8_t {
+    kYoungBit = 1,
+    kOldBit = 2,
+    kMarkBit = 4,
+};
+
+// Drops the objects of `space` past `size`. Those that live on, e.g. as results or inside the
+// parse tree, leave the collector's view and so must not keep its bits, or the next Keep()
+// would take them for kept and a Mark() would stop at them.
+void Truncate(std::vector<Ref<Object>>* space, size_t size) {
+    if (space->size() <= size) {
+        return;
+    }
+    for (auto it = space->begin() + size; it != space->end(); ++it) {
+        // Pinned objects carry no bits and may be in use on other threads.
+        if ((*it)->GetGcBits()) {
+            (*it)->SetGcBits(0);
+        }
+    }
+    space->resize(size);
+}
+
+}  // namespace
+
+Interpreter::Interpreter(const InterpreterOptions& options)
+    : parse_cache_(options.parse_cache), gc_options_(options.gc) {
+    if (options.use_region) {
+        region_ = std::make_unique<Arena>();
+    }
+}
+
 std::string Interpreter::Run(const std::string& str) {
-    auto ast = Eval(ReadFull(str));
+    if (region_) {
+        ArenaScope scope{region_.get()};
+        return RunInScope(str);
+    }
+    return RunInScope(str);
+}
 
-    if (Is<Symbol>(ast)) {
-        return As<Symbol>(ast)->GetName();
-    } else if (Is<Number>(ast)) {
-        return std::to_string(As<Number>(ast)->GetValue());
-    } else {
-        throw RuntimeError{"runtime error"};
+Ref<Object> Interpreter::Evaluate(const std::string& str) {
+    if (region_) {
+        ArenaScope scope{region_.get()};
+        return PromoteToHeap(Eval(Parse(str)));
     }
+    return Eval(Parse(str));
 }
 
-std::shared_ptr<Object> Interpreter::Eval(std::shared_ptr<Object> tree) {
-    if (Is<Number>(tree)) {
+Ref<Object> Interpreter::Parse(const std::string& str) {
+    if (!parse_cache_) {
+        return ReadFull(str);
+    }
+    Ref<Object> tree;
+    if (parse_cache_->Find(str, &tree)) {
         return tree;
+    }
+    {
+        // Cached trees outlive this request, so they cannot come from the region.
+        ArenaScope heap{nullptr};
+        tree = ReadFull(str);
+    }
+    parse_cache_->Insert(str, tree);
+    return tree;
+}
+
+std::string Interpreter::RunInScope(const std::string& str) {
+    ScratchScope scratch{this};
+    // The result may point into the tree.
+    Ref<Object> tree = Parse(str);
+    Value result = EvalValue(tree);
+    std::string out;
+    Print(result, &out);
+    return out;
+}
+
+Interpreter::ScratchScope::ScratchScope(Interpreter* interpreter)
+    : interpreter_(interpreter),
+      stack_size_(interpreter->stack_.size()),
+      temporaries_size_(interpreter->temporaries_.size()),
+      tenured_size_(interpreter->tenured_.size()) {
+}
+
+// Collections only ever shrink the spaces, so truncating to the saved sizes drops whatever
+// this scope added and nothing from outside it.
+Interpreter::ScratchScope::~ScratchScope() {
+    interpreter_->stack_.resize(stack_size_);
+    Truncate(&interpreter_->temporaries_, temporaries_size_);
+    Truncate(&interpreter_->tenured_, tenured_size_);
+}
+
+GcStats Interpreter::GetGcStats() const {
+    return gc_stats_;
+}
+
+Value Interpreter::Keep(Ref<Object> object) {
+    Value value = ToValue(object);
+    if (!value.IsHeap() && !value.IsBoxed()) {
+        return value;
+    }
+    if (object->GetGcBits()) {
+        // Kept already.
+        return value;
+    }
+    // Objects shared across threads cannot take collector bits; they are pinned instead and
+    // stay alive until the evaluation ends.
+    if (!object->IsShared()) {
+        object->SetGcBits(kYoungBit);
+    }
+    temporaries_.push_back(std::move(object));
+    if (temporaries_.size() >= gc_options_.nursery_objects) {
+        CollectGarbage(value);
+    }
+    return value;
+}
+
+void Interpreter::CollectGarbage(Value extra_root) {
+    auto start = std::chrono::steady_clock::now();
+    Mark(extra_root, kYoungBit);
+    size_t promoted = tenured_.size();
+    gc_stats_.released += Sweep(&temporaries_, &tenured_);
+    promoted = tenured_.size() - promoted;
+    gc_stats_.promoted += promoted;
+    ++gc_stats_.minor_collections;
+    for (size_t i = tenured_.size() - promoted; i < tenured_.size(); ++i) {
+        if (tenured_[i]->GetGcBits()) {
+            tenured_[i]->SetGcBits(kOldBit);
+        }
+    }
+    if (tenured_.size() > gc_options_.old_objects) {
+        Mark(extra_root, kOldBit);
+        gc_stats_.released += Sweep(&tenured_, nullptr);
+        ++gc_stats_.major_collections;
+    }
+    uint64_t pause = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    gc_stats_.total_pause_ns += pause;
+    gc_stats_.max_pause_ns = std::max(gc_stats_.max_pause_ns, pause);
+}
+
+void Interpreter::Mark(Value extra_root, uint8_t bits) {
+    std::vector<const Object*> pending;
+    auto add_root = [&](Value value) {
+        if (value.IsHeap()) {
+            pending.push_back(value.GetHeap());
+        } else if (value.IsBoxed()) {
+            pending.push_back(value.GetBoxed());
+        }
+    };
+    add_root(extra_root);
+    for (Value value : stack_) {
+        add_root(value);
+    }
+    while (!pending.empty()) {
+        const Object* object = pending.back();
+        pending.pop_back();
+        // Objects without bits, i.e. parse tree nodes and the inner cells of built lists, are
+        // not traced. What they point at lives on through its count for as long as they do.
+        if (!object || !(object->GetGcBits() & bits) || (object->GetGcBits() & kMarkBit)) {
+            continue;
+        }
+        object->SetGcBits(object->GetGcBits() | kMarkBit);
+        if (auto cell = As<Cell>(object)) {
+            pending.push_back(cell->GetFirst().get());
+            pending.push_back(cell->GetSecond().get());
+        }
+    }
+}
+
+size_t Interpreter::Sweep(std::vector<Ref<Object>>* space, std::vector<Ref<Object>>* survivors) {
+    size_t kept = 0;
+    size_t released = 0;
+    for (auto& object : *space) {
+        uint8_t bits = object->GetGcBits();
+        if (!bits || (bits & kMarkBit)) {
+            // Pinned objects carry no bits and may be in use on other threads.
+            if (bits) {
+                object->SetGcBits(bits & ~kMarkBit);
+            }
+            if (survivors) {
+                survivors->push_back(std::move(object));
+            } else {
+                (*space)[kept++] = std::move(object);
+            }
+        } else {
+            object->SetGcBits(0);
+            object.reset();
+            ++released;
+        }
+    }
+    space->resize(kept);
+    return released;
+}
+
+namespace {
+
+// The empty list is null inside cells.
+Ref<Object> ToListElement(Value value) {
+    return value.IsNil() ? nullptr : ToObject(value);
+}
+
+}  // namespace
+
+Value Interpreter::MakeList(std::span<const Value> elements, Value tail) {
+    if (elements.empty()) {
+        return tail;
+    }
+    auto element = [elements](size_t i) { return ToListElement(elements[i]); };
+    return Keep(MakeListObject(elements.size(), element, ToListElement(tail)));
+}
+
+Value Interpreter::KeepBorrowed(Value value) {
+    return value.IsHeap() || value.IsBoxed() ? Keep(ToObject(value)) : value;
+}
+
+Value Interpreter::MakeNumber(int64_t number) {
+    if (Value::FitsFixnum(number)) {
+        return Value::Fixnum(number);
+    }
+    return Keep(MakeObject<Number>(number));
+}
+
+Ref<Object> Interpreter::Eval(Ref<Object> tree) {
+    ScratchScope scratch{this};
+    return ToObject(EvalValue(tree));
+}
+
+Value Interpreter::EvalValue(const Ref<Object>& tree) {
+    if (Is<Number>(tree)) {
+        return ToValue(tree);
     } else if (Is<Symbol>(tree)) {
-        if (As<Symbol>(tree)->GetName() == "#t" || As<Symbol>(tree)->GetName() == "#f") {
-            return tree;
+        if (As<Symbol>(tree)->Matches(BuiltinSymbol::BOOL_TRUE) ||
+            As<Symbol>(tree)->Matches(BuiltinSymbol::BOOL_FALSE)) {
+            return ToValue(tree);
         } else {
             throw RuntimeError{"runtime error"};
         }
     } else if (Is<Cell>(tree)) {
-        auto next = As<Cell>(tree)->GetFirst();
-        if (Is<Symbol>(next)) {
-            if (As<Symbol>(next)->GetName() == "quote") {
-                if (!(As<Cell>(tree)->GetSecond())) {
-                    return std::make_shared<Symbol>(Symbol{"()"});
-                } else {
-                    return std::make_shared<Symbol>(Symbol{Tostring(As<Cell>(tree)->GetSecond())});
-                }
-            } else if (As<Symbol>(next)->GetName() == "or") {
-                return Or(As<Cell>(tree)->GetSecond());
-            } else if (As<Symbol>(next)->GetName() == "and") {
-                return And(As<Cell>(tree)->GetSecond());
-            } else if (As<Symbol>(next)->GetName() == "list") {
-                std::string result = Tostring(As<Cell>(tree)->GetSecond());
-                return std::make_shared<Symbol>(Symbol{"(" + result + ")"});
-            } else if (As<Symbol>(next)->GetName() == "cons") {
-                auto result = std::make_shared<Cell>(Cell());
-                if (!Is<Cell>(As<Cell>(tree)->GetSecond())) {
-                    throw RuntimeError{"runtime error"};
-                }
-                auto first = As<Cell>(As<Cell>(tree)->GetSecond());
-                auto second = first->GetSecond();
-                if (!Is<Cell>(second)) {
-                    throw RuntimeError{"runtime error"};
-                }
-                result->AppendFirst(first->GetFirst());
-                result->AppendSecond(As<Cell>(second)->GetFirst());
-                return std::make_shared<Symbol>(Symbol{"(" + Tostring(result) + ")"});
-            } else if (auto search = function_list.find(As<Symbol>(next)->GetName());
-                       search != function_list.end()) {
-                std::vector<std::shared_ptr<Object>> args =
-                    BuildArguments(As<Cell>(tree)->GetSecond());
-                return Execute(As<Symbol>(next)->GetName(), args);
-            } else if (auto search2 = for_list.find(As<Symbol>(next)->GetName());
-                       search2 != for_list.end()) {
-                auto arg = (As<Cell>(tree)->GetSecond());
-                if (!Is<Cell>(arg)) {
-                    throw RuntimeError{"runtime error"};
-                }
-                if (!Is<Cell>(As<Cell>(arg)->GetSecond())) {
-                    return ExecuteList(As<Symbol>(next)->GetName(), As<Cell>(arg)->GetFirst(),
-                                       nullptr);
+        const auto& next = As<Cell>(tree)->GetFirst();
+        if (!Is<Symbol>(next)) {
+            throw RuntimeError{"runtime error"};
+        }
+        SymbolId id = As<Symbol>(next)->GetId();
+        switch (id) {
+            case ToId(BuiltinSymbol::QUOTE): {
+                // The datum itself, shared with the tree; (quote) is the empty list.
+                const auto& args = As<Cell>(tree)->GetSecond();
+                return ToValue(Is<Cell>(args) ? As<Cell>(args)->GetFirst() : args);
+            }
+            case ToId(BuiltinSymbol::OR):
+                return OrValue(As<Cell>(tree)->GetSecond().get());
+            case ToId(BuiltinSymbol::AND):
+                return AndValue(As<Cell>(tree)->GetSecond().get());
+            default:
+                break;
+        }
+        if (IsFunctionId(id) || IsListFunctionId(id)) {
+            // Arguments go on stack_ and are handed to the builtin in place. A dotted tail is
+            // taken as it is, without evaluation.
+            size_t base = stack_.size();
+            for (Object* pair = As<Cell>(tree)->GetSecond().get(); pair;) {
+                if (Is<Symbol>(pair) || Is<Number>(pair)) {
+                    stack_.push_back(ToValue(pair));
+                    break;
                 }
-                return ExecuteList(As<Symbol>(next)->GetName(), As<Cell>(arg)->GetFirst(),
-                                   As<Cell>(As<Cell>(arg)->GetSecond())->GetFirst());
-            } else {
-                throw NameError{"wrong argument"};
+                Value arg = EvalValue(As<Cell>(pair)->GetFirst());
+                stack_.push_back(arg);
+                pair = As<Cell>(pair)->GetSecond().get();
             }
+            Value result = Apply(id, std::span<const Value>(stack_).subspan(base));
+            stack_.resize(base);
+            return result;
         } else {
-            throw RuntimeError{"runtime error"};
+            throw NameError{"wrong argument"};
         }
     } else {
         throw RuntimeError{"runtime error"};
     }
 };
 
-std::shared_ptr<Object> Interpreter::ReadFull(const std::string& str) {
-    std::stringstream ss{str};
-    Tokenizer tokenizer{&ss};
-
-    auto obj = Read(&tokenizer);
-    if (!tokenizer.IsEnd()) {
-        throw SyntaxError{"syntax error"};
-    }
-    return obj;
+Ref<Object> Interpreter::ReadFull(const std::string& str) {
+    return TryReadFull(str).ValueOrThrow();
 };
 
-std::vector<std::shared_ptr<Object>> Interpreter::BuildArguments(std::shared_ptr<Object> pair) {
-    std::vector<std::shared_ptr<Object>> args;
-    while (pair) {
-        if (Is<Symbol>(pair) || Is<Number>(pair)) {
-            args.push_back(pair);
-            pair = nullptr;
-        } else {
-            args.push_back(Eval(As<Cell>(pair)->GetFirst()));
-            pair = As<Cell>(pair)->GetSecond();
-        }
-    }
-    return args;
-};
+std::string Interpreter::Tostring(const Ref<Object>& tree) {
+    std::string out;
+    Print(ToValue(tree), &out);
+    return out;
+}
 
-std::string Interpreter::Tostring(std::shared_ptr<Object> tree) {
-    std::string ans;
-    bool open = false;
-    while (tree != nullptr) {
-        if (Is<Symbol>(tree)) {
-            ans += As<Symbol>(tree)->GetName();
-            tree = nullptr;
-        } else if (Is<Number>(tree)) {
-            ans += std::to_string(As<Number>(tree)->GetValue());
-            tree = nullptr;
-        } else {
-            auto next = As<Cell>(tree)->GetFirst();
-            if (!As<Cell>(tree)->GetFirst() && !As<Cell>(tree)->GetSecond()) {
-                ans += "()";
-                tree = nullptr;
-            } else if (Is<Cell>(next)) {
-                open = true;
-                ans += "(";
-                ans += Tostring(next);
-                tree = As<Cell>(tree)->GetSecond();
-            } else {
-                ans += Tostring(next);
-                if (Is<Number>(next) && Is<Number>(As<Cell>(tree)->GetSecond())) {
-                    ans += " .";
-                };
-                tree = As<Cell>(tree)->GetSecond();
-                if (tree != nullptr) {
-                    ans += " ";
-                }
-            }
+void Interpreter::Print(Value value, std::string* out) {
+    if (value.IsNumber()) {
+        *out += std::to_string(value.GetNumber());
+    } else if (value.IsTrue()) {
+        *out += "#t";
+    } else if (value.IsFalse()) {
+        *out += "#f";
+    } else if (value.IsNil()) {
+        *out += "()";
+    } else if (value.IsSymbol()) {
+        *out += value.GetSymbol()->name;
+    } else if (const Cell* cell = AsCell(value)) {
+        *out += '(';
+        Print(ToValue(cell->GetFirst()), out);
+        while (const Cell* next = cell->Next()) {
+            *out += ' ';
+            Print(ToValue(next->GetFirst()), out);
+            cell = next;
         }
+        if (const auto& tail = cell->GetSecond()) {
+            *out += " . ";
+            Print(ToValue(tail), out);
+        }
+        *out += ')';
+    } else {
+        throw RuntimeError{"runtime error"};
     }
-    if (open) {
-        ans += ")";
-    }
-    return ans;
-};
+}
+
+Ref<Object> Interpreter::Or(Ref<Object> pair) {
+    ScratchScope scratch{this};
+    return ToObject(OrValue(pair.get()));
+}
 
-std::shared_ptr<Object> Interpreter::Or(std::shared_ptr<Object> pair) {
-    bool result = false;
-    std::shared_ptr<Object> first_true = nullptr;
+Ref<Object> Interpreter::And(Ref<Object> pair) {
+    ScratchScope scratch{this};
+    return ToObject(AndValue(pair.get()));
+}
+
+// Only #t and numbers count as true here.
+Value Interpreter::OrValue(Object* pair) {
     while (pair) {
-        if ((Is<Symbol>(pair) && As<Symbol>(pair)->GetName() == "#t") || Is<Number>(pair)) {
-            first_true = pair;
-            result = true;
-            break;
-        } else if (Is<Symbol>(pair)) {
-            pair = nullptr;
-        } else {
-            auto object = Eval(As<Cell>(pair)->GetFirst());
-            if ((Is<Symbol>(object) && As<Symbol>(object)->GetName() == "#t") ||
-                Is<Number>(object)) {
-                first_true = object;
-                result = true;
-                break;
-            }
-            pair = As<Cell>(pair)->GetSecond();
+        if (Is<Symbol>(pair) || Is<Number>(pair)) {
+            Value tail = ToValue(pair);
+            return tail.IsTrue() || tail.IsNumber() ? tail : Value::Bool(false);
         }
+        Value value = EvalValue(As<Cell>(pair)->GetFirst());
+        if (value.IsTrue() || value.IsNumber()) {
+            return value;
+        }
+        pair = As<Cell>(pair)->GetSecond().get();
     }
-    if (result) {
-        return first_true;
-    }
-    return std::make_shared<Symbol>(Symbol{"#f"});
+    return Value::Bool(false);
 }
 
-std::shared_ptr<Object> Interpreter::And(std::shared_ptr<Object> pair) {
-    bool result = true;
-    std::shared_ptr<Object> first_false = nullptr;
-    std::shared_ptr<Object> last = std::make_shared<Symbol>(Symbol{"#t"});
+Value Interpreter::AndValue(Object* pair) {
+    Value last = Value::Bool(true);
     while (pair) {
-        if (Is<Symbol>(pair) && As<Symbol>(pair)->GetName() == "#f") {
-            first_false = pair;
-            result = false;
-            break;
-        } else if (Is<Symbol>(pair) || Is<Number>(pair)) {
-            last = pair;
-            pair = nullptr;
-        } else {
-            auto object = Eval(As<Cell>(pair)->GetFirst());
-            if (Is<Symbol>(object) && As<Symbol>(object)->GetName() == "#f") {
-                first_false = object;
-                result = false;
-                break;
-            } else if (Is<Symbol>(object) || Is<Number>(object)) {
-                last = object;
-            }
-            pair = As<Cell>(pair)->GetSecond();
+        if (Is<Symbol>(pair) || Is<Number>(pair)) {
+            return ToValue(pair);
+        }
+        last = EvalValue(As<Cell>(pair)->GetFirst());
+        if (last.IsFalse()) {
+            return last;
         }
+        pair = As<Cell>(pair)->GetSecond().get();
     }
-    if (result) {
-        return last;
+    return last;
+}
+
+Ref<Object> Interpreter::Execute(SymbolId id, std::vector<Ref<Object>> args) {
+    ScratchScope scratch{this};
+    std::vector<Value> values;
+    for (const auto& arg : args) {
+        values.push_back(ToValue(arg));
     }
-    return first_false;
+    return ToObject(Apply(id, values));
 }
 
-std::shared_ptr<Object> Interpreter::Execute(const std::string& name,
-                                             std::vector<std::shared_ptr<Object>> args) {
-    if (name == "number?") {
-        return IsNumber{}(args);
-    } else if (name == "=") {
-        return Equal{}(args);
-    } else if (name == ">") {
-        return Increasing{}(args);
-    } else if (name == "<") {
-        return Decreasing{}(args);
-    } else if (name == ">=") {
-        return Nondecreasing{}(args);
-    } else if (name == "<=") {
-        return Nonincreasing{}(args);
-    } else if (name == "+") {
-        return Add{}(args);
-    } else if (name == "-") {
-        return Sub{}(args);
-    } else if (name == "*") {
-        return Mul{}(args);
-    } else if (name == "/") {
-        return Div{}(args);
-    } else if (name == "max") {
-        return Max{}(args);
-    } else if (name == "min") {
-        return Min{}(args);
-    } else if (name == "abs") {
-        return Abs{}(args);
-    } else if (name == "boolean?") {
-        return IsBool{}(args);
-    } else if (name == "not") {
-        return Not{}(args);
-    } else {
-        throw RuntimeError{"runtime-error"};
+Value Interpreter::Apply(SymbolId id, std::span<const Value> args) {
+    switch (static_cast<BuiltinSymbol>(id)) {
+        case BuiltinSymbol::IS_NUMBER:
+            return Value::Bool(IsNumber{}(args));
+        case BuiltinSymbol::EQUAL:
+            return Value::Bool(Equal{}(args));
+        case BuiltinSymbol::INCREASING:
+            return Value::Bool(Increasing{}(args));
+        case BuiltinSymbol::DECREASING:
+            return Value::Bool(Decreasing{}(args));
+        case BuiltinSymbol::NONDECREASING:
+            return Value::Bool(Nondecreasing{}(args));
+        case BuiltinSymbol::NONINCREASING:
+            return Value::Bool(Nonincreasing{}(args));
+        case BuiltinSymbol::ADD:
+            return MakeNumber(Add{}(args));
+        case BuiltinSymbol::SUB:
+            return MakeNumber(Sub{}(args));
+        case BuiltinSymbol::MUL:
+            return MakeNumber(Mul{}(args));
+        case BuiltinSymbol::DIV:
+            return MakeNumber(Div{}(args));
+        case BuiltinSymbol::MAX:
+            return MakeNumber(Max{}(args));
+        case BuiltinSymbol::MIN:
+            return MakeNumber(Min{}(args));
+        case BuiltinSymbol::ABS:
+            return MakeNumber(Abs{}(args));
+        case BuiltinSymbol::IS_BOOLEAN:
+            return Value::Bool(IsBool{}(args));
+        case BuiltinSymbol::NOT:
+            return Value::Bool(Not{}(args));
+        case BuiltinSymbol::LIST:
+            return MakeList(args, Value::Nil());
+        case BuiltinSymbol::CONS:
+            if (args.size() != 2) {
+                throw RuntimeError{"runtime-error"};
+            }
+            return MakeList(args.first(1), args[1]);
+        case BuiltinSymbol::IS_PAIR:
+            return Value::Bool(IsPair{}(args));
+        case BuiltinSymbol::IS_NULL:
+            return Value::Bool(IsNull{}(args));
+        case BuiltinSymbol::IS_LIST:
+            return Value::Bool(IsList{}(args));
+        case BuiltinSymbol::CAR:
+            return KeepBorrowed(Car{}(args));
+        case BuiltinSymbol::CDR:
+            return KeepBorrowed(Cdr{}(args));
+        case BuiltinSymbol::LIST_REF:
+            return KeepBorrowed(ListRef{}(args));
+        case BuiltinSymbol::LIST_TAIL:
+            return KeepBorrowed(ListTail{}(args));
+        default:
+            throw RuntimeError{"runtime-error"};
     }
 }
 
-std::shared_ptr<Object> Interpreter::ExecuteList(const std::string& name,
-                                                 std::shared_ptr<Object> arg,
-                                                 std::shared_ptr<Object> param) {
-    if (name == "pair?") {
-        return IsPair{}(arg, param);
-    } else if (name == "null?") {
-        return IsNull{}(arg, param);
-    } else if (name == "list?") {
-        return IsList{}(arg, param);
-    } else if (name == "car") {
-        return Car{}(arg, param);
-    } else if (name == "cdr") {
-        return Cdr{}(arg, param);
-    } else if (name == "list-ref") {
-        return ListRef{}(arg, param);
-    } else if (name == "list-tail") {
-        return ListTail{}(arg, param);
-    } else {
-        throw RuntimeError{"runtime-error"};
+Ref<Object> Interpreter::ExecuteList(SymbolId id, Ref<Object> arg, Ref<Object> param) {
+    ScratchScope scratch{this};
+    std::vector<Value> values{ToValue(arg)};
+    if (param) {
+        values.push_back(ToValue(param));
     }
+    return ToObject(Apply(id, values));
 }
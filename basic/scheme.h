@@ -5,38 +5,158 @@
 #include "object.h"
 #include "tokenizer.h"
 #include "parser.h"
-#include <sstream>
-#include <set>
+#include "parse_cache.h"
 #include "error.h"
 
-static std::set<std::string> function_list{
-    "number?", "=", ">",   "<",   ">=",  "<=",       "-",  "+",
-    "*",       "/", "max", "min", "abs", "boolean?", "not"};
+// Builtins taking evaluated arguments, dispatched by Interpreter::Execute().
+constexpr bool IsFunctionId(SymbolId id) {
+    return id >= ToId(BuiltinSymbol::IS_NUMBER) && id <= ToId(BuiltinSymbol::NOT);
+}
 
-static std::set<std::string> for_list{"pair?", "null?",    "list?",    "car",
-                                      "cdr",   "list-ref", "list-tail"};
+// Builtins building or taking lists, which take evaluated arguments too. Also dispatched by
+// Interpreter::Execute(), or by Interpreter::ExecuteList().
+constexpr bool IsListFunctionId(SymbolId id) {
+    return id == ToId(BuiltinSymbol::LIST) || id == ToId(BuiltinSymbol::CONS) ||
+           (id >= ToId(BuiltinSymbol::IS_PAIR) && id <= ToId(BuiltinSymbol::LIST_TAIL));
+}
+
+// Objects created during an evaluation start in the nursery. A minor collection traces the
+// nursery from the interpreter's roots, promotes what is reachable to the old space and
+// releases the rest; a major collection does the same for the old space.
+//
+// The collector is a retention list layered on reference counting: the spaces hold one
+// reference to each kept object, and releasing that reference frees the object only if
+// nothing else still counts it. The language cannot build cycles, so counting frees all.
+struct GcOptions {
+    // Minor collection once the nursery holds this many objects.
+    size_t nursery_objects = 1024;
+    // Major collection once a minor one leaves more objects than this in the old space.
+    size_t old_objects = 64 * 1024;
+};
+
+struct GcStats {
+    uint64_t minor_collections = 0;
+    uint64_t major_collections = 0;
+    uint64_t promoted = 0;
+    // References the collections dropped. The object goes with it unless other references
+    // keep it alive, so this counts an upper bound of the objects freed.
+    uint64_t released = 0;
+    uint64_t total_pause_ns = 0;
+    // Longest single collection.
+    uint64_t max_pause_ns = 0;
+};
+
+struct InterpreterOptions {
+    // Allocate everything a Run() creates from an arena owned by the interpreter and release
+    // it in one step when the call returns, instead of freeing objects one by one.
+    bool use_region = false;
+
+    // Parse trees of previously seen requests; may be shared with other interpreters. On a
+    // hit, Run() skips tokenizing and parsing altogether.
+    std::shared_ptr<ParseCache> parse_cache;
+
+    GcOptions gc;
+};
 
 class Interpreter {
 public:
-    std::string Tostring(std::shared_ptr<Object> tree);
+    Interpreter() = default;
 
-    std::vector<std::shared_ptr<Object>> BuildArguments(std::shared_ptr<Object> pair);
+    explicit Interpreter(const InterpreterOptions& options);
 
-    std::shared_ptr<Object> ReadFull(const std::string& str);
+    std::string Tostring(const Ref<Object>& tree);
 
-    std::shared_ptr<Object> Eval(std::shared_ptr<Object> tree);
+    Ref<Object> ReadFull(const std::string& str);
+
+    // Evaluation runs on Values; the methods taking and returning objects convert at the
+    // boundary.
+    Ref<Object> Eval(Ref<Object> tree);
 
     std::string Run(const std::string& str);
 
-    std::shared_ptr<Object> Or(std::shared_ptr<Object> tree);
+    // Like Run(), but returns the value itself. In region mode it is promoted to the heap, as
+    // it has to outlive the region.
+    Ref<Object> Evaluate(const std::string& str);
+
+    Ref<Object> Or(Ref<Object> tree);
+
+    Ref<Object> And(Ref<Object> tree);
+
+    Ref<Object> Execute(SymbolId id, std::vector<Ref<Object>> args);
+
+    // `arg` is the evaluated list; `param` may be null.
+    Ref<Object> ExecuteList(SymbolId id, Ref<Object> arg, Ref<Object> param);
+
+    GcStats GetGcStats() const;
+
+private:
+    // Restores the argument stack and the temporaries to their size at construction when it
+    // goes out of scope, also by an exception, and so before a region is reset.
+    class ScratchScope {
+    public:
+        explicit ScratchScope(Interpreter* interpreter);
+        ~ScratchScope();
+
+    private:
+        Interpreter* interpreter_;
+        size_t stack_size_;
+        size_t temporaries_size_;
+        size_t tenured_size_;
+    };
+
+    std::string RunInScope(const std::string& str);
+
+    Value EvalValue(const Ref<Object>& tree);
+
+    Value OrValue(Object* pair);
+
+    Value AndValue(Object* pair);
+
+    // Runs a builtin of IsFunctionId() or IsListFunctionId() on evaluated arguments.
+    Value Apply(SymbolId id, std::span<const Value> args);
+
+    // Value of an object created during evaluation. The object joins the nursery and stays
+    // alive while it is reachable from the roots, at most until the outermost evaluation ends.
+    // May run a collection, whose roots are stack_ and the returned value: every other value
+    // still needed afterwards has to be pushed onto stack_ first.
+    Value Keep(Ref<Object> object);
+
+    void CollectGarbage(Value extra_root);
+
+    // Marks what is reachable from the roots among objects carrying any of `bits`.
+    void Mark(Value extra_root, uint8_t bits);
+
+    // Keeps the marked and the pinned objects of `space`, moving them to `survivors` if given,
+    // and clears the mark. Returns the number of released objects.
+    size_t Sweep(std::vector<Ref<Object>>* space, std::vector<Ref<Object>>* survivors);
+
+    // Keep() for a value taken out of a list. Only the head cell of a built list is kept, so
+    // an inner cell or an element can be freed with the list while the value is still in use.
+    Value KeepBorrowed(Value value);
+
+    // Fixnum, or a boxed Number kept as by Keep().
+    Value MakeNumber(int64_t number);
+
+    // New cells holding `elements` in front of `tail`, kept as by Keep().
+    Value MakeList(std::span<const Value> elements, Value tail);
+
+    // External representation of a value, as Run() returns it.
+    void Print(Value value, std::string* out);
+
+    // ReadFull() through the parse cache, if there is one.
+    Ref<Object> Parse(const std::string& str);
 
-    std::shared_ptr<Object> And(std::shared_ptr<Object> tree);
+    std::unique_ptr<Arena> region_;
+    std::shared_ptr<ParseCache> parse_cache_;
 
-    std::shared_ptr<Object> Execute(const std::string& name,
-                                    std::vector<std::shared_ptr<Object>> args);
+    // Arguments of the builtin calls in progress, innermost last.
+    std::vector<Value> stack_;
 
-    std::shared_ptr<Object> ExecuteList(const std::string& name, std::shared_ptr<Object> arg,
-                                        std::shared_ptr<Object> param);
+    // The nursery and the old space. Objects are immutable once kept, and an object is only
+    // ever kept after its children, so the old space never points into the nursery.
+    std::vector<Ref<Object>> temporaries_;
+    std::vector<Ref<Object>> tenured_;
 
-    friend class Object;
+    GcOptions gc_options_;
+    GcStats gc_stats_;
 };
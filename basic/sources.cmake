@@ -1,7 +1,20 @@
 add_library(scheme_basic
+    arena.cpp
+    ast_cache.cpp
+    char_class.cpp
+    event_reader.cpp
+    hash_cons.cpp
+    incremental_parser.cpp
+    lazy_forms.cpp
+    loader.cpp
     tokenizer.cpp
     parser.cpp
+    parse_cache.cpp
+    pool.cpp
     scheme.cpp
+    structural_index.cpp
+    symbol_table.cpp
+    thread_pool.cpp
     
     # maybe more .cpp files here
 )
@@ -0,0 +1,174 @@
+#include "structural_index.h"
+
+#include <cstring>
+
+#include "error.h"
+#include "form_boundary.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SCHEME_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// One bit per byte of a 64-byte block.
+struct BlockMasks {
+    uint64_t open;
+    uint64_t close;
+    uint64_t quote;
+    uint64_t space;
+};
+
+BlockMasks ClassifyScalar(const char* block) {
+    BlockMasks masks{};
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = uint64_t{1} << i;
+        char c = block[i];
+        masks.open |= c == '(' ? bit : 0;
+        masks.close |= c == ')' ? bit : 0;
+        masks.quote |= c == '\'' ? bit : 0;
+        masks.space |= HasCharClass(c, kSpaceBit) ? bit : 0;
+    }
+    return masks;
+}
+
+#ifdef SCHEME_X86_SIMD
+
+__attribute__((target("sse2"))) inline uint64_t ByteBits(__m128i chunk, char c) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c))));
+}
+
+__attribute__((target("avx2"))) inline uint64_t ByteBits(__m256i chunk, char c) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c))));
+}
+
+// One overload per instruction set, so that the SSE2 path never runs AVX-encoded code.
+__attribute__((target("sse2"))) inline void AddChunk(__m128i chunk, int shift,
+                                                     BlockMasks* masks) {
+    masks->open |= ByteBits(chunk, '(') << shift;
+    masks->close |= ByteBits(chunk, ')') << shift;
+    masks->quote |= ByteBits(chunk, '\'') << shift;
+    masks->space |= (ByteBits(chunk, ' ') | ByteBits(chunk, '\n') | ByteBits(chunk, '\t') |
+                     ByteBits(chunk, '\r'))
+                    << shift;
+}
+
+__attribute__((target("avx2"))) inline void AddChunk(__m256i chunk, int shift,
+                                                     BlockMasks* masks) {
+    masks->open |= ByteBits(chunk, '(') << shift;
+    masks->close |= ByteBits(chunk, ')') << shift;
+    masks->quote |= ByteBits(chunk, '\'') << shift;
+    masks->space |= (ByteBits(chunk, ' ') | ByteBits(chunk, '\n') | ByteBits(chunk, '\t') |
+                     ByteBits(chunk, '\r'))
+                    << shift;
+}
+
+struct Sse2Classifier {
+    __attribute__((target("sse2"))) static BlockMasks Classify(const char* block) {
+        BlockMasks masks{};
+        for (int i = 0; i < 4; ++i) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+            AddChunk(chunk, 16 * i, &masks);
+        }
+        return masks;
+    }
+};
+
+struct Avx2Classifier {
+    __attribute__((target("avx2"))) static BlockMasks Classify(const char* block) {
+        BlockMasks masks{};
+        for (int i = 0; i < 2; ++i) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+            AddChunk(chunk, 32 * i, &masks);
+        }
+        return masks;
+    }
+};
+
+#endif
+
+struct ScalarClassifier {
+    static BlockMasks Classify(const char* block) {
+        return ClassifyScalar(block);
+    }
+};
+
+void Append(uint64_t bits, uint32_t base, std::vector<uint32_t>* positions) {
+    while (bits) {
+        positions->push_back(base + __builtin_ctzll(bits));
+        bits &= bits - 1;
+    }
+}
+
+template <class Classifier>
+StructuralIndex Build(std::string_view source) {
+    StructuralIndex index;
+    // Whether the previous block ended inside an atom.
+    uint64_t atom_carry = 0;
+    auto consume = [&](const BlockMasks& masks, uint32_t base) {
+        uint64_t atom = ~(masks.open | masks.close | masks.quote | masks.space);
+        uint64_t atom_start = atom & ~((atom << 1) | atom_carry);
+        atom_carry = atom >> 63;
+        Append(masks.open | masks.close | masks.quote | atom_start, base, &index.positions);
+    };
+
+    size_t pos = 0;
+    for (; pos + 64 <= source.size(); pos += 64) {
+        consume(Classifier::Classify(source.data() + pos), pos);
+    }
+    if (pos < source.size()) {
+        // The tail is padded with spaces, which are not structural.
+        char block[64];
+        std::memset(block, ' ', sizeof(block));
+        std::memcpy(block, source.data() + pos, source.size() - pos);
+        consume(Classifier::Classify(block), pos);
+    }
+    return index;
+}
+
+}  // namespace
+
+std::vector<uint32_t> StructuralIndex::FormStarts(std::string_view source) const {
+    std::vector<uint32_t> starts;
+    FormBoundary boundary(source);
+    for (uint32_t pos : positions) {
+        // An atom at the top level may hold several tokens; each one after the first begins a
+        // form that has no structural position of its own.
+        for (size_t at = pos;;) {
+            if (boundary.AtStart()) {
+                starts.push_back(at);
+            }
+            size_t end = boundary.Take(at);
+            if (!boundary.InAtom(end)) {
+                break;
+            }
+            at = end;
+        }
+    }
+    return starts;
+}
+
+StructuralIndex BuildStructuralIndex(std::string_view source, ScanLevel level) {
+    if (source.size() > UINT32_MAX) {
+        throw RuntimeError{"source too large for a structural index"};
+    }
+    if (level > DetectScanLevel()) {
+        level = DetectScanLevel();
+    }
+#ifdef SCHEME_X86_SIMD
+    if (level == ScanLevel::AVX2) {
+        return Build<Avx2Classifier>(source);
+    }
+    if (level == ScanLevel::SSE42) {
+        return Build<Sse2Classifier>(source);
+    }
+#endif
+    return Build<ScalarClassifier>(source);
+}
+
+StructuralIndex BuildStructuralIndex(std::string_view source) {
+    static const ScanLevel kLevel = DetectScanLevel();
+    return BuildStructuralIndex(source, kLevel);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "char_class.h"
+
+// Stage one of a two-stage reader in the style of simdjson: one vectorized pass classifies every
+// byte and records the positions that carry structure. Those are brackets, quotes and the first
+// byte of every atom (a run of bytes that are none of these nor whitespace). Whitespace and the
+// rest of each atom are skipped, so later stages walk far fewer positions than bytes.
+struct StructuralIndex {
+    std::vector<uint32_t> positions;
+
+    // Start of every top-level form as FormBoundary (form_boundary.h) splits them: the position
+    // of its opening bracket, its token, or the first of the quotes in front of it.
+    std::vector<uint32_t> FormStarts(std::string_view source) const;
+};
+
+StructuralIndex BuildStructuralIndex(std::string_view source, ScanLevel level);
+
+// Uses DetectScanLevel().
+StructuralIndex BuildStructuralIndex(std::string_view source);
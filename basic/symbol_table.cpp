@@ -0,0 +1,61 @@
+#include "symbol_table.h"
+
+#include <mutex>
+
+namespace {
+
+constexpr std::string_view kBuiltinNames[] = {
+    "quote", "or", "and", "list", "cons", "#t", "#f", "()",
+    "number?", "=", ">", "<", ">=", "<=", "+", "-", "*", "/", "max", "min", "abs", "boolean?",
+    "not",
+    "pair?", "null?", "list?", "car", "cdr", "list-ref", "list-tail"};
+
+static_assert(std::size(kBuiltinNames) == ToId(BuiltinSymbol::COUNT));
+
+}  // namespace
+
+SymbolTable& SymbolTable::Global() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolTable::SymbolTable() {
+    for (size_t i = 0; i < std::size(kBuiltinNames); ++i) {
+        builtins_[i] = Intern(kBuiltinNames[i]);
+    }
+}
+
+const InternedSymbol* SymbolTable::Intern(std::string_view name) {
+    if (auto symbol = Find(name)) {
+        return symbol;
+    }
+    std::unique_lock lock{mutex_};
+    if (auto it = by_name_.find(name); it != by_name_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<SymbolId>(symbols_.size());
+    symbols_.push_back(std::make_unique<InternedSymbol>(InternedSymbol{id, std::string(name)}));
+    const InternedSymbol* symbol = symbols_.back().get();
+    by_name_.emplace(symbol->name, symbol);
+    return symbol;
+}
+
+const InternedSymbol* SymbolTable::Find(std::string_view name) const {
+    std::shared_lock lock{mutex_};
+    auto it = by_name_.find(name);
+    return it != by_name_.end() ? it->second : nullptr;
+}
+
+const InternedSymbol* SymbolTable::Get(SymbolId id) const {
+    std::shared_lock lock{mutex_};
+    return symbols_[id].get();
+}
+
+const InternedSymbol* SymbolTable::Get(BuiltinSymbol symbol) const {
+    return builtins_[ToId(symbol)];
+}
+
+size_t SymbolTable::Size() const {
+    std::shared_lock lock{mutex_};
+    return symbols_.size();
+}
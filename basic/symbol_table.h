@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using SymbolId = uint32_t;
+
+// Names the evaluator dispatches on. They are interned first, in this order, so their ids are
+// the enum values and `switch` works on SymbolId directly.
+enum class BuiltinSymbol : SymbolId {
+    QUOTE,
+    OR,
+    AND,
+    LIST,
+    CONS,
+    BOOL_TRUE,
+    BOOL_FALSE,
+    EMPTY_LIST,
+
+    // Functions over evaluated arguments, see Interpreter::Execute().
+    IS_NUMBER,
+    EQUAL,
+    INCREASING,
+    DECREASING,
+    NONDECREASING,
+    NONINCREASING,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MAX,
+    MIN,
+    ABS,
+    IS_BOOLEAN,
+    NOT,
+
+    // Functions over lists, see Interpreter::ExecuteList().
+    IS_PAIR,
+    IS_NULL,
+    IS_LIST,
+    CAR,
+    CDR,
+    LIST_REF,
+    LIST_TAIL,
+
+    COUNT
+};
+
+constexpr SymbolId ToId(BuiltinSymbol symbol) {
+    return static_cast<SymbolId>(symbol);
+}
+
+struct InternedSymbol {
+    SymbolId id;
+    std::string name;
+};
+
+// Process-wide set of symbol names. Every distinct name is stored once and never freed, so an
+// InternedSymbol pointer identifies a name for the lifetime of the process. Safe to use from
+// several threads.
+class SymbolTable {
+public:
+    static SymbolTable& Global();
+
+    const InternedSymbol* Intern(std::string_view name);
+
+    // Looks a name up without adding it.
+    const InternedSymbol* Find(std::string_view name) const;
+
+    const InternedSymbol* Get(SymbolId id) const;
+
+    // Lock-free: builtins are fixed at construction.
+    const InternedSymbol* Get(BuiltinSymbol symbol) const;
+
+    size_t Size() const;
+
+private:
+    SymbolTable();
+
+    mutable std::shared_mutex mutex_;
+    // Keys are views into the names owned by symbols_.
+    std::unordered_map<std::string_view, const InternedSymbol*> by_name_;
+    std::vector<std::unique_ptr<InternedSymbol>> symbols_;
+    const InternedSymbol* builtins_[ToId(BuiltinSymbol::COUNT)];
+};
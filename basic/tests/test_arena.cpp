@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <arena.h>
+#include <scheme.h>
+
+TEST_CASE("Arena hands out aligned memory and resets") {
+    Arena arena{1024};
+    auto first = arena.Allocate(3, 1);
+    auto second = arena.Allocate(8, 8);
+    REQUIRE(reinterpret_cast<uintptr_t>(second) % 8 == 0);
+    REQUIRE(second > first);
+    REQUIRE(arena.BytesUsed() == 11);
+
+    auto big = arena.Allocate(4096, 16);
+    REQUIRE(reinterpret_cast<uintptr_t>(big) % 16 == 0);
+    REQUIRE(arena.ChunkCount() == 2);
+
+    arena.Reset();
+    REQUIRE(arena.BytesUsed() == 0);
+    REQUIRE(arena.ChunkCount() == 1);
+    REQUIRE(arena.Allocate(3, 1) == first);
+}
+
+TEST_CASE("Objects come from the current arena") {
+    Arena arena;
+    Ref<Object> promoted;
+    REQUIRE(Arena::Current() == nullptr);
+    {
+        ArenaScope scope{&arena};
+        REQUIRE(Arena::Current() == &arena);
+        auto list = MakeObject<Cell>();
+        list->AppendFirst(MakeObject<Number>(1));
+        list->AppendSecond(MakeObject<Symbol>("x"));
+        REQUIRE(arena.BytesUsed() > 0);
+
+        size_t used = arena.BytesUsed();
+        promoted = PromoteToHeap(list);
+        REQUIRE(arena.BytesUsed() == used);
+    }
+    REQUIRE(Arena::Current() == nullptr);
+    REQUIRE(arena.BytesUsed() == 0);
+
+    MakeObject<Number>(1);
+    REQUIRE(arena.BytesUsed() == 0);
+
+    REQUIRE(As<Number>(As<Cell>(promoted)->GetFirst())->GetValue() == 1);
+    REQUIRE(As<Symbol>(As<Cell>(promoted)->GetSecond())->GetName() == "x");
+}
+
+TEST_CASE("Interpreter in region mode") {
+    Interpreter interpreter{InterpreterOptions{.use_region = true}};
+
+    REQUIRE(interpreter.Run("(+ 1 2 (* 3 4))") == "15");
+    REQUIRE(interpreter.Run("'(1 2 . 3)") == "(1 2 . 3)");
+    REQUIRE(interpreter.Run("(and 1 2 (max 3 7))") == "7");
+    REQUIRE(interpreter.Run("(cdr '(1 2 3))") == "(2 3)");
+    REQUIRE_THROWS_AS(interpreter.Run("(1 . 2 3)"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.Run("(+ #t 1)"), RuntimeError);
+    REQUIRE(interpreter.Run("(- 10 (abs -4))") == "6");
+
+    SECTION("Kept results are promoted out of the region") {
+        auto value = interpreter.Evaluate("(+ 40 2)");
+        auto list = interpreter.Evaluate("(list 1 2)");
+        interpreter.Run("(+ 1 1)");
+        REQUIRE(As<Number>(value)->GetValue() == 42);
+        REQUIRE(interpreter.Tostring(list) == "(1 2)");
+    }
+}
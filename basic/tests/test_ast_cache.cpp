@@ -0,0 +1,125 @@
+#include <catch.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <ast_cache.h>
+#include <loader.h>
+#include <scheme.h>
+
+namespace {
+
+std::vector<std::string> Print(const std::vector<Ref<Object>>& forms) {
+    Interpreter interpreter;
+    std::vector<std::string> printed;
+    for (const auto& form : forms) {
+        printed.push_back(form ? interpreter.Tostring(form) : "()");
+    }
+    return printed;
+}
+
+void WriteText(const std::string& path, const std::string& text) {
+    std::ofstream{path, std::ios::binary | std::ios::trunc} << text;
+}
+
+}  // namespace
+
+TEST_CASE("Encoded forms decode to the same trees") {
+    std::string source =
+        "(define (f x) (* x 2)) 'sym -9223372036854775808 9223372036854775807 () (1 . 2) "
+        "(a (b (c d) . e) f) #t";
+    auto forms = ReadAll(source);
+    auto data = EncodeForms(forms, HashSource(source));
+    auto decoded = DecodeForms(data, HashSource(source));
+    REQUIRE(decoded);
+    REQUIRE(Print(decoded.Value()) == Print(forms));
+
+    auto stale = DecodeForms(data, HashSource(source + " "));
+    REQUIRE(stale.Error().message == "AST cache is stale");
+    REQUIRE(!DecodeForms("not a cache", 0));
+}
+
+TEST_CASE("Decoding deep trees does not recurse") {
+    size_t depth = 200000;
+    std::string source = std::string(depth, '(') + "1" + std::string(depth, ')');
+    LoadOptions options;
+    options.reader.max_depth = depth;
+    auto forms = ReadAll(source, nullptr, options);
+    auto data = EncodeForms(forms, 1);
+    auto decoded = DecodeForms(data, 1);
+    REQUIRE(decoded);
+    REQUIRE(EncodeForms(decoded.Value(), 1) == data);
+}
+
+TEST_CASE("Damaged caches are rejected") {
+    auto data = EncodeForms(ReadAll("(x 1 (y 300)) 'z"), 7);
+    for (size_t size = 0; size < data.size(); ++size) {
+        REQUIRE(!DecodeForms(std::string_view(data).substr(0, size), 7));
+    }
+    REQUIRE(!DecodeForms(data + "x", 7));
+    for (size_t i = 24; i < data.size(); ++i) {
+        auto damaged = data;
+        damaged[i] = '\xff';
+        // Must not crash; whether the result decodes depends on the byte.
+        DecodeForms(damaged, 7);
+    }
+}
+
+TEST_CASE("Source files are loaded through the cache") {
+    auto dir = std::filesystem::temp_directory_path();
+    auto path = (dir / ("scheme_ast_cache_" + std::to_string(getpid()) + ".scm")).string();
+    auto cache_path = path + ".ast";
+    std::remove(cache_path.c_str());
+
+    WriteText(path, "(a 1) (b 2)");
+    auto first = LoadSourceFile(path);
+    REQUIRE(std::filesystem::exists(cache_path));
+    REQUIRE(LoadAstFile(cache_path, HashSource("(a 1) (b 2)")));
+    REQUIRE(Print(LoadSourceFile(path)) == Print(first));
+
+    WriteText(path, "(c 3)");
+    REQUIRE(Print(LoadSourceFile(path)) == Print(ReadAll("(c 3)")));
+    REQUIRE(LoadAstFile(cache_path, HashSource("(c 3)")));
+
+    WriteText(path, "(c");
+    REQUIRE_THROWS_AS(LoadSourceFile(path), SyntaxError);
+    std::remove(path.c_str());
+    std::remove(cache_path.c_str());
+    REQUIRE_THROWS_AS(LoadSourceFile(path), RuntimeError);
+}
+
+TEST_CASE("Caches may be written from several threads at once") {
+    auto dir = std::filesystem::temp_directory_path() /
+               ("scheme_ast_writers_" + std::to_string(getpid()));
+    std::filesystem::create_directory(dir);
+    auto cache_path = (dir / "forms.ast").string();
+    std::string source = "(define (f x) (* x 2)) (f 21)";
+    auto forms = ReadAll(source);
+
+    std::vector<std::thread> writers;
+    std::vector<int> failures(8);
+    for (size_t t = 0; t < failures.size(); ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 50; ++i) {
+                try {
+                    WriteAstFile(cache_path, forms, HashSource(source));
+                } catch (const RuntimeError&) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    REQUIRE(failures == std::vector<int>(8));
+    auto loaded = LoadAstFile(cache_path, HashSource(source));
+    REQUIRE(loaded);
+    REQUIRE(Print(loaded.Value()) == Print(forms));
+    // No temporary file is left behind.
+    REQUIRE(std::distance(std::filesystem::directory_iterator{dir},
+                          std::filesystem::directory_iterator{}) == 1);
+    std::filesystem::remove_all(dir);
+}
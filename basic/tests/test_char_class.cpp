@@ -0,0 +1,64 @@
+#include <catch.hpp>
+
+#include <char_class.h>
+
+#include <random>
+#include <string>
+
+namespace {
+
+const char kAlphabet[] = " \n\t()'.+-*/<=>?!#09azAZ_\x80\xff";
+
+std::string RandomRuns(std::default_random_engine* rng, size_t size) {
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+    std::uniform_int_distribution<size_t> run(1, 70);
+    std::string s;
+    while (s.size() < size) {
+        s.append(run(*rng), kAlphabet[pick(*rng)]);
+    }
+    s.resize(size);
+    return s;
+}
+
+}  // namespace
+
+TEST_CASE("Character classes") {
+    REQUIRE(HasCharClass(' ', kSpaceBit));
+    REQUIRE(HasCharClass('\n', kSpaceBit));
+    REQUIRE(HasCharClass('7', kDigitBit | kSymbolBit));
+    REQUIRE(!HasCharClass('7', kStartSymbolBit));
+    REQUIRE(HasCharClass('#', kStartSymbolBit));
+    REQUIRE(HasCharClass('?', kSymbolBit));
+    REQUIRE(!HasCharClass('?', kStartSymbolBit));
+    REQUIRE(!HasCharClass('+', kSymbolBit));
+    REQUIRE(!HasCharClass('\xff', kSpaceBit | kDigitBit | kSymbolBit));
+}
+
+TEST_CASE("Vector scanners agree with the scalar one") {
+    const CharScanner& scalar = GetCharScanner(ScanLevel::SCALAR);
+    std::default_random_engine rng{42};
+    for (auto level : {ScanLevel::SSE42, ScanLevel::AVX2}) {
+        const CharScanner& scanner = GetCharScanner(level);
+        for (size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+            auto input = RandomRuns(&rng, size);
+            const char* end = input.data() + input.size();
+            for (const char* p = input.data(); p <= end; ++p) {
+                REQUIRE(scanner.skip_spaces(p, end) == scalar.skip_spaces(p, end));
+                REQUIRE(scanner.skip_symbol(p, end) == scalar.skip_symbol(p, end));
+                REQUIRE(scanner.skip_digits(p, end) == scalar.skip_digits(p, end));
+            }
+        }
+    }
+}
+
+TEST_CASE("Scanners skip long runs") {
+    std::string input(100000, ' ');
+    input += "x";
+    const char* end = input.data() + input.size();
+    REQUIRE(GetCharScanner().skip_spaces(input.data(), end) == end - 1);
+
+    std::string symbol(100000, 'a');
+    symbol += ")";
+    end = symbol.data() + symbol.size();
+    REQUIRE(GetCharScanner().skip_symbol(symbol.data(), end) == end - 1);
+}
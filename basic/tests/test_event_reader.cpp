@@ -0,0 +1,154 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <streambuf>
+
+#include <event_reader.h>
+
+namespace {
+
+class TraceHandler : public ReadHandler {
+public:
+    void OnBeginList() override {
+        trace += "( ";
+    }
+    void OnEndList() override {
+        trace += ") ";
+    }
+    void OnNumber(int64_t value) override {
+        trace += std::to_string(value) + " ";
+    }
+    void OnSymbol(std::string_view name) override {
+        trace += "sym:" + std::string(name) + " ";
+    }
+    void OnDot() override {
+        trace += ". ";
+    }
+    void OnQuote() override {
+        trace += "' ";
+    }
+    void OnDatumEnd() override {
+        trace += "| ";
+    }
+
+    std::string trace;
+};
+
+std::string Trace(const std::string& input) {
+    std::stringstream ss{input};
+    Tokenizer tokenizer{&ss};
+    TraceHandler handler;
+    ReadAllEvents(&tokenizer, &handler);
+    return handler.trace;
+}
+
+std::string ErrorOf(const std::string& input) {
+    std::stringstream ss{input};
+    Tokenizer tokenizer{&ss};
+    ReadHandler handler;
+    try {
+        ReadAllEvents(&tokenizer, &handler);
+    } catch (const SyntaxError& error) {
+        return error.what();
+    }
+    return "";
+}
+
+// Produces "(0 1 2 ...)" on the fly, so the input never exists in memory as a whole.
+class CountingBuf : public std::streambuf {
+public:
+    explicit CountingBuf(int64_t count) : count_(count) {
+        Refill();
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() == egptr() && !Refill()) {
+            return traits_type::eof();
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    bool Refill() {
+        buffer_.clear();
+        if (next_ == 0 && !opened_) {
+            buffer_ = "(";
+            opened_ = true;
+        }
+        while (buffer_.size() < 4096 && next_ < count_) {
+            buffer_ += std::to_string(next_++) + " ";
+        }
+        if (next_ == count_ && !closed_ && buffer_.size() < 4096) {
+            buffer_ += ")";
+            closed_ = true;
+        }
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + buffer_.size());
+        return !buffer_.empty();
+    }
+
+    int64_t count_;
+    int64_t next_ = 0;
+    bool opened_ = false;
+    bool closed_ = false;
+    std::string buffer_;
+};
+
+class SumHandler : public ReadHandler {
+public:
+    void OnBeginList() override {
+        ++depth;
+        max_depth = std::max(max_depth, depth);
+    }
+    void OnEndList() override {
+        --depth;
+    }
+    void OnNumber(int64_t value) override {
+        sum += value;
+        ++count;
+    }
+
+    int64_t sum = 0;
+    int64_t count = 0;
+    int depth = 0;
+    int max_depth = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Events follow the input") {
+    REQUIRE(Trace("(a . 'b)") == "( sym:a . ' sym:b ) | ");
+    REQUIRE(Trace("1 (2 (3)) 'x") == "1 | ( 2 ( 3 ) ) | ' sym:x | ");
+    REQUIRE(Trace("'(()) -5") == "' ( ( ) ) | -5 | ");
+    REQUIRE(Trace("  ").empty());
+}
+
+TEST_CASE("Event reader rejects what the tree reader rejects") {
+    for (std::string input : {"(1 . )", "(. 1)", "(1 . 2 3)", ")", ".", "'", "(1", "(1 . 2 . 3)",
+                              "('"}) {
+        INFO(input);
+        auto expected = TryReadFull(input);
+        REQUIRE(!expected);
+        REQUIRE(ErrorOf(input) == expected.Error().message);
+    }
+
+    std::stringstream ss{std::string(100, '(')};
+    Tokenizer tokenizer{&ss};
+    ReadHandler handler;
+    REQUIRE_THROWS_WITH(ReadEvents(&tokenizer, &handler, ReaderOptions{.max_depth = 50}),
+                        "nesting too deep");
+}
+
+TEST_CASE("Event reader streams through large inputs") {
+    int64_t count = 1000000;
+    CountingBuf buf{count};
+    std::istream in{&buf};
+    Tokenizer tokenizer{&in};
+    SumHandler handler;
+    ReadEvents(&tokenizer, &handler);
+    REQUIRE(tokenizer.IsEnd());
+    REQUIRE(handler.count == count);
+    REQUIRE(handler.sum == count * (count - 1) / 2);
+    REQUIRE(handler.max_depth == 1);
+    REQUIRE(handler.depth == 0);
+}
@@ -0,0 +1,92 @@
+#include <catch.hpp>
+
+#include <scheme.h>
+
+namespace {
+
+std::string Repeat(const std::string& head, const std::string& item, int count) {
+    std::string source = "(" + head;
+    for (int i = 1; i <= count; ++i) {
+        source += " " + item + std::to_string(i) + ")";
+    }
+    return source + ")";
+}
+
+// Whether any object of the tree carries collector bits.
+bool HasGcBits(const Ref<Object>& tree) {
+    std::vector<const Object*> pending{tree.get()};
+    while (!pending.empty()) {
+        const Object* object = pending.back();
+        pending.pop_back();
+        if (!object) {
+            continue;
+        }
+        if (object->GetGcBits()) {
+            return true;
+        }
+        if (auto cell = As<Cell>(object)) {
+            pending.push_back(cell->GetFirst().get());
+            pending.push_back(cell->GetSecond().get());
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+TEST_CASE("Unreachable temporaries are collected") {
+    Interpreter interpreter{InterpreterOptions{.gc = {.nursery_objects = 16}}};
+    REQUIRE(interpreter.Run(Repeat("or", "(list ", 500)) == "#f");
+    auto stats = interpreter.GetGcStats();
+    REQUIRE(stats.minor_collections >= 500 / 16);
+    REQUIRE(stats.released >= 450);
+    REQUIRE(stats.promoted < 50);
+}
+
+TEST_CASE("Reachable temporaries survive collections") {
+    for (bool use_region : {false, true}) {
+        Interpreter interpreter{InterpreterOptions{
+            .use_region = use_region, .gc = {.nursery_objects = 4, .old_objects = 8}}};
+        // Each argument is a boxed number that stays on the argument stack.
+        REQUIRE(interpreter.Run(Repeat("max 1", "(+ 4611686018427387903 ", 40)) ==
+                "4611686018427387943");
+        auto stats = interpreter.GetGcStats();
+        REQUIRE(stats.promoted >= 30);
+        REQUIRE(stats.major_collections > 0);
+        auto result = interpreter.Evaluate(Repeat("min 9", "(- -4611686018427387904 ", 40));
+        REQUIRE(As<Number>(result)->GetValue() == -4611686018427387944);
+    }
+}
+
+TEST_CASE("Collections leave cached trees intact") {
+    auto cache = std::make_shared<ParseCache>();
+    Interpreter interpreter{InterpreterOptions{.parse_cache = cache, .gc = {.nursery_objects = 2}}};
+    std::string source = "(+ 1 4611686018427387905 (- 0 4611686018427387905) 0)";
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(interpreter.Run(source) == "1");
+    }
+}
+
+TEST_CASE("Values taken out of a list outlive it") {
+    Interpreter interpreter{InterpreterOptions{.gc = {.nursery_objects = 4, .old_objects = 8}}};
+    std::string source = "(list (cdr (list 1 2 3)) (car (list (list 4)))";
+    std::string expected = "((2 3) (4)";
+    for (int i = 0; i < 100; ++i) {
+        source += " (list 5)";
+        expected += " (5)";
+    }
+    REQUIRE(interpreter.Run(source + ")") == expected + ")");
+    REQUIRE(interpreter.GetGcStats().minor_collections > 0);
+}
+
+TEST_CASE("Objects that outlive an evaluation carry no collector bits") {
+    Interpreter interpreter{InterpreterOptions{.gc = {.nursery_objects = 4, .old_objects = 8}}};
+    auto tree = interpreter.ReadFull("(list (car '((1 2) 3)) (cdr (list 4 5 6)) (list 7))");
+    auto result = interpreter.Eval(tree);
+    REQUIRE(interpreter.Tostring(result) == "((1 2) (5 6) (7))");
+    REQUIRE(interpreter.GetGcStats().minor_collections > 0);
+    REQUIRE(!HasGcBits(tree));
+    REQUIRE(!HasGcBits(result));
+    // Both can go into the next evaluation.
+    REQUIRE(interpreter.Tostring(interpreter.Eval(tree)) == "((1 2) (5 6) (7))");
+}
@@ -0,0 +1,80 @@
+#include <catch.hpp>
+
+#include <ast_cache.h>
+#include <hash_cons.h>
+#include <loader.h>
+#include <parser.h>
+#include <scheme.h>
+
+namespace {
+
+Ref<Object> Nth(Ref<Object> list, int index) {
+    while (index--) {
+        list = As<Cell>(list)->GetSecond();
+    }
+    return As<Cell>(list)->GetFirst();
+}
+
+}  // namespace
+
+TEST_CASE("Equal subtrees are shared") {
+    HashConsTable table;
+    ReaderOptions options{.hash_cons = &table};
+    auto tree = TryReadFull("('() (1 2 . 3) '() (1 2 . 3) (x (1 2 . 3)) 7 7)", options).Value();
+    REQUIRE(Nth(tree, 0) == Nth(tree, 2));
+    REQUIRE(Nth(tree, 1) == Nth(tree, 3));
+    REQUIRE(As<Cell>(As<Cell>(Nth(tree, 4))->GetSecond())->GetFirst() == Nth(tree, 1));
+    REQUIRE(Nth(tree, 5) == Nth(tree, 6));
+    REQUIRE(Nth(tree, 0) != Nth(tree, 1));
+
+    // Across reads too.
+    auto again = TryReadFull("(1 2 . 3)", options).Value();
+    REQUIRE(again == Nth(tree, 1));
+    REQUIRE(TryReadFull("'()", options).Value() == Nth(tree, 0));
+
+    // Leaves with a shared immortal object use it.
+    REQUIRE(Nth(tree, 5) == NumberObject(7));
+    REQUIRE(table.MakeSymbol("#t") == BoolObject(true));
+    REQUIRE(table.MakeNumber(1 << 20) == table.MakeNumber(1 << 20));
+    REQUIRE_FALSE(table.MakeNumber(1 << 20)->IsImmortal());
+}
+
+TEST_CASE("Hash-consed trees read like regular ones") {
+    HashConsTable table;
+    LoadOptions options;
+    options.reader.hash_cons = &table;
+    ThreadPool pool{2};
+    for (std::string source :
+         {"(a (b . c) 'd '(e f) () (()) 1 -2)", "x '(1 . (2 . (3 . ()))) (((1)))", "(a . b)"}) {
+        INFO(source);
+        auto plain = ReadAll(source);
+        auto shared = ReadAll(source, &pool, options);
+        REQUIRE(EncodeForms(shared, 0) == EncodeForms(plain, 0));
+    }
+    for (std::string bad : {"(. 1)", "(1 . )", "(1 . 2 3)", "'"}) {
+        REQUIRE(TryReadAll(bad, nullptr, options).Error().message ==
+                TryReadAll(bad).Error().message);
+    }
+}
+
+TEST_CASE("Repeated data take one allocation") {
+    HashConsTable table;
+    LoadOptions options;
+    options.reader.hash_cons = &table;
+    std::string source;
+    for (int i = 0; i < 1000; ++i) {
+        source += "(row " + std::to_string(i % 10) + " '() (1 2 3))\n";
+    }
+    auto forms = ReadAll(source, nullptr, options);
+    REQUIRE(forms.size() == 1000);
+    REQUIRE(forms[3] == forms[13]);
+    // 10 distinct rows of 4 cells, (quote ()) and (1 2 3), plus the leaves.
+    REQUIRE(table.Size() < 100);
+
+    Interpreter interpreter;
+    REQUIRE(interpreter.Eval(TryReadFull("(+ 1 (+ 1 1))", options.reader).Value()) != nullptr);
+    table.Clear();
+    REQUIRE(table.Size() == 0);
+    // Clearing the table does not invalidate trees that are still referenced.
+    REQUIRE(EncodeForms({forms[0]}, 0) == EncodeForms(ReadAll("(row 0 '() (1 2 3))"), 0));
+}
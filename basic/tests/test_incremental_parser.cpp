@@ -0,0 +1,99 @@
+#include <catch.hpp>
+
+#include <random>
+
+#include <ast_cache.h>
+#include <incremental_parser.h>
+#include <loader.h>
+
+namespace {
+
+// Reading the whole text from scratch, form by form, is what an incremental parser must match.
+void RequireMatchesFullParse(const IncrementalParser& parser) {
+    LoadOptions options;
+    options.min_chunk_bytes = 1;
+    auto expected = TryReadAll(parser.Text(), nullptr, options);
+    auto actual = parser.Trees();
+    REQUIRE(actual.HasValue() == expected.HasValue());
+    if (expected) {
+        REQUIRE(EncodeForms(actual.Value(), 0) == EncodeForms(expected.Value(), 0));
+    } else {
+        REQUIRE(actual.Error().message == expected.Error().message);
+    }
+    size_t pos = 0;
+    for (const auto& form : parser.Forms()) {
+        REQUIRE(form.begin == pos);
+        pos = form.end;
+    }
+    REQUIRE(pos == parser.Text().size());
+}
+
+}  // namespace
+
+TEST_CASE("Edits reparse only the forms they touch") {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "(define x" + std::to_string(i) + " (list 1 2 3))\n";
+    }
+    IncrementalParser parser{text};
+    REQUIRE(parser.Forms().size() == 1001);
+    auto before = parser.Forms();
+
+    size_t offset = parser.Forms()[500].begin + 10;
+    parser.Edit(offset, 1, "yy");
+    RequireMatchesFullParse(parser);
+    REQUIRE(parser.LastReparsedBytes() < 40);
+    REQUIRE(parser.Forms().size() == 1001);
+    REQUIRE(parser.Forms()[499].trees.Value()[0] == before[499].trees.Value()[0]);
+    REQUIRE(parser.Forms()[501].trees.Value()[0] == before[501].trees.Value()[0]);
+    REQUIRE(parser.Forms()[501].begin == before[501].begin + 1);
+
+    // Unbalancing a form swallows the rest of the buffer until the bracket is back.
+    size_t close = parser.Forms()[10].end - 1;
+    parser.Edit(close, 1, "");
+    RequireMatchesFullParse(parser);
+    REQUIRE(!parser.Trees());
+    parser.Edit(close, 0, ")");
+    RequireMatchesFullParse(parser);
+    REQUIRE(parser.LastReparsedBytes() < 40);
+    REQUIRE(parser.Forms().size() == 1001);
+    REQUIRE(parser.Forms()[900].trees.Value()[0] == before[900].trees.Value()[0]);
+}
+
+TEST_CASE("Edits at form boundaries") {
+    IncrementalParser parser{"ab cd"};
+    parser.Edit(2, 0, "x");
+    REQUIRE(parser.Text() == "abx cd");
+    RequireMatchesFullParse(parser);
+    parser.Edit(3, 1, "");
+    REQUIRE(parser.Text() == "abxcd");
+    RequireMatchesFullParse(parser);
+    REQUIRE(parser.Forms().size() == 1);
+    parser.Edit(0, 0, "'");
+    parser.Edit(5, 1, "");
+    RequireMatchesFullParse(parser);
+    parser.Edit(0, parser.Text().size(), "");
+    REQUIRE(parser.Forms().empty());
+    parser.Edit(0, 0, " 1 ");
+    RequireMatchesFullParse(parser);
+    REQUIRE_THROWS_AS(parser.Edit(2, 5, ""), RuntimeError);
+}
+
+TEST_CASE("Random edits match a full reparse") {
+    std::mt19937 random{42};
+    const std::string alphabet = "()' \n.ab1-";
+    auto random_text = [&](size_t size) {
+        std::string text;
+        for (size_t i = 0; i < size; ++i) {
+            text += alphabet[random() % alphabet.size()];
+        }
+        return text;
+    };
+    IncrementalParser parser{"(a (b 1) '(c . d)) (e) 12 (f (g))"};
+    for (int i = 0; i < 2000; ++i) {
+        size_t offset = random() % (parser.Text().size() + 1);
+        size_t length = random() % std::min<size_t>(4, parser.Text().size() - offset + 1);
+        parser.Edit(offset, length, random_text(random() % 4));
+        RequireMatchesFullParse(parser);
+    }
+}
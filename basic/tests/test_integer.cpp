@@ -112,3 +112,11 @@ TEST_CASE_METHOD(SchemeTest, "IntegerAbsEdgeCases") {
     ExpectRuntimeError("(abs #t)");
     ExpectRuntimeError("(abs 1 2)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "IntegersAre64Bit") {
+    ExpectEq("4294967296", "4294967296");
+    ExpectEq("(+ 4000000000 1)", "4000000001");
+    ExpectEq("(max -20000000000 -30000000000)", "-20000000000");
+    ExpectEq("(min 20000000000 30000000000)", "20000000000");
+    ExpectSyntaxError("9223372036854775808");
+}
@@ -0,0 +1,101 @@
+#include <catch.hpp>
+
+#include <random>
+
+#include <lazy_forms.h>
+#include <loader.h>
+#include <scheme.h>
+#include <structural_index.h>
+
+namespace {
+
+std::vector<uint32_t> Positions(std::string_view source, ScanLevel level) {
+    return BuildStructuralIndex(source, level).positions;
+}
+
+// Reference: the first non-space byte of every piece the loader's pre-pass finds.
+std::vector<uint32_t> ExpectedStarts(std::string_view source) {
+    std::vector<uint32_t> starts;
+    size_t pos = 0;
+    for (auto piece : SplitTopLevelForms(source, 1)) {
+        size_t skip = piece.find_first_not_of(" \n\t\r");
+        if (skip != std::string_view::npos) {
+            starts.push_back(pos + skip);
+        }
+        pos += piece.size();
+    }
+    return starts;
+}
+
+}  // namespace
+
+TEST_CASE("Structural index marks brackets, quotes and atom starts") {
+    std::string source = "(define (f x) '(1 . -2))\n  abc";
+    std::vector<uint32_t> expected{0, 1, 8, 9, 11, 12, 14, 15, 16, 18, 20, 22, 23, 27};
+    for (auto level : {ScanLevel::SCALAR, ScanLevel::SSE42, ScanLevel::AVX2}) {
+        REQUIRE(Positions(source, level) == expected);
+    }
+    REQUIRE(BuildStructuralIndex(source).FormStarts(source) == std::vector<uint32_t>{0, 27});
+}
+
+TEST_CASE("Structural index agrees across levels and with the loader") {
+    std::mt19937 random{7};
+    const std::string alphabet = "()' \n\tab1-.";
+    for (int round = 0; round < 300; ++round) {
+        std::string source;
+        size_t size = random() % 300;
+        for (size_t i = 0; i < size; ++i) {
+            source += alphabet[random() % alphabet.size()];
+        }
+        auto scalar = Positions(source, ScanLevel::SCALAR);
+        REQUIRE(Positions(source, ScanLevel::SSE42) == scalar);
+        REQUIRE(Positions(source, ScanLevel::AVX2) == scalar);
+        REQUIRE(BuildStructuralIndex(source).FormStarts(source) == ExpectedStarts(source));
+    }
+}
+
+TEST_CASE("Forms are read on first use") {
+    std::string source = "(a 1) 'b (c (d)) (broken . ) 42";
+    LazyForms forms{source};
+    REQUIRE(forms.Size() == 5);
+    REQUIRE(forms.ReadCount() == 0);
+    REQUIRE(forms.Text(2) == "(c (d)) ");
+
+    auto first = forms.Get(4);
+    REQUIRE(As<Number>(first)->GetValue() == 42);
+    REQUIRE(forms.Get(4) == first);
+    REQUIRE(forms.ReadCount() == 1);
+
+    REQUIRE(forms.Get(0) != nullptr);
+    REQUIRE(forms.TryGet(3).Error().message == "expected a datum after '.'");
+    REQUIRE_THROWS_AS(forms.Get(3), SyntaxError);
+    REQUIRE(forms.ReadCount() == 3);
+    REQUIRE_THROWS(forms.Get(5));
+}
+
+TEST_CASE("Lazy forms and the loader read the same forms") {
+    Interpreter interpreter;
+    for (std::string_view source :
+         {"1a (x)", "(x) 1a", "'1a b", "-1a", "1-2", "+5x", "-a", "x'y", "1(a)", "(a)b", "12 34",
+          "a1 2", "''a-1 (b) c", "a.b", "?x", "(a ?) b", "(1)) 2"}) {
+        INFO(source);
+        REQUIRE(BuildStructuralIndex(source).FormStarts(source) == ExpectedStarts(source));
+        auto all = TryReadAll(source, nullptr, LoadOptions{{}, 1});
+        LazyForms forms{source};
+        bool failed = false;
+        for (size_t i = 0; i < forms.Size(); ++i) {
+            auto form = forms.TryGet(i);
+            if (!form) {
+                failed = true;
+            } else if (all) {
+                REQUIRE(i < all.Value().size());
+                REQUIRE(interpreter.Tostring(form.Value()) ==
+                        interpreter.Tostring(all.Value()[i]));
+            }
+        }
+        REQUIRE(failed == !all);
+        if (all) {
+            REQUIRE(forms.Size() == all.Value().size());
+        }
+    }
+}
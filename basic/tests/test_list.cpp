@@ -77,3 +77,81 @@ TEST_CASE_METHOD(SchemeTest, "ListOperations") {
     ExpectRuntimeError("(list-ref '(1 2 3) 10)");
     ExpectRuntimeError("(list-tail '(1 2 3) 10)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "ListsAreValues") {
+    ExpectEq("(car (list 1 2))", "1");
+    ExpectEq("(cdr (cons 1 (list 2 3)))", "(2 3)");
+    ExpectEq("(list (+ 1 2) 'x '(a b))", "(3 x (a b))");
+    ExpectEq("(list-ref (list 1 (list 2 3)) 1)", "(2 3)");
+    ExpectEq("(car (car '((1) 2)))", "1");
+    ExpectEq("(cons 1 '())", "(1)");
+    ExpectEq("(cons '(1) 2)", "((1) . 2)");
+    ExpectEq("(pair? (cons 1 2))", "#t");
+    ExpectEq("(null? (cdr (list 1)))", "#t");
+    ExpectEq("(list? (cons 1 (list 2)))", "#t");
+    ExpectEq("(list? (cons 1 2))", "#f");
+    ExpectEq("(list-tail (list 1 2 3) (- 3 1))", "(3)");
+
+    ExpectRuntimeError("(car 1)");
+    ExpectRuntimeError("(cons 1)");
+    ExpectRuntimeError("(list-ref '(1 2) -1)");
+}
+
+TEST_CASE("List results share structure with their input") {
+    Interpreter interpreter;
+    auto tree = interpreter.ReadFull("(cdr '(1 2 3))");
+    auto quoted = As<Cell>(As<Cell>(As<Cell>(tree)->GetSecond())->GetFirst())->GetSecond();
+    auto list = As<Cell>(quoted)->GetFirst();
+    REQUIRE(interpreter.Eval(tree) == As<Cell>(list)->GetSecond());
+
+    auto built = interpreter.Evaluate("(cons 0 '(1 2))");
+    REQUIRE(interpreter.Tostring(built) == "(0 1 2)");
+    REQUIRE(As<Number>(As<Cell>(built)->GetFirst())->GetValue() == 0);
+}
+
+TEST_CASE("Lists are laid out as runs of adjacent cells") {
+    Arena arena;
+    ArenaScope scope{&arena};
+    auto read = TryReadFull("(1 (2 3) 4 5)").Value();
+    auto built = MakeListObject(5, [](size_t i) { return NumberObject(i); }, nullptr);
+    for (const auto& list : {read, built}) {
+        for (auto cell = As<Cell>(list); cell->GetSecond(); cell = As<Cell>(cell->GetSecond())) {
+            REQUIRE(cell->GetSecond().get() == cell + 1);
+        }
+    }
+}
+
+TEST_CASE("Building a list frees its cells when an element throws") {
+    auto before = ObjectPool<Cell>::Stats().live;
+    auto element = [](size_t i) {
+        if (i == 5) {
+            throw RuntimeError{"element"};
+        }
+        return NumberObject(i);
+    };
+    REQUIRE_THROWS_AS(MakeListObject(8, element, nullptr), RuntimeError);
+    REQUIRE(ObjectPool<Cell>::Stats().live == before);
+}
+
+TEST_CASE("A run does not go on into an adjacent object that is not a pair") {
+    Arena arena;
+    ArenaScope scope{&arena};
+    auto list = MakeListObject(2, [](size_t i) { return NumberObject(i); }, nullptr);
+    auto last = As<Cell>(list)->Next();
+    auto tail = MakeObject<Symbol>("z");
+    REQUIRE(static_cast<const Object*>(last + 1) == tail.get());
+    const_cast<Cell*>(last)->AppendSecond(tail);
+    REQUIRE(last->Next() == nullptr);
+    REQUIRE(Interpreter{}.Tostring(list) == "(0 1 . z)");
+}
+
+TEST_CASE("Runs fall back to pointers when a tail is replaced") {
+    Interpreter interpreter;
+    auto list = interpreter.Evaluate("(list 1 2 3 4)");
+    auto tail = interpreter.Evaluate("(list-tail (list 1 2 3 4) 2)");
+    As<Cell>(As<Cell>(list)->GetSecond())->AppendSecond(tail);
+    REQUIRE(As<Cell>(list)->Next()->Next() == tail.get());
+    REQUIRE(interpreter.Tostring(list) == "(1 2 3 4)");
+    REQUIRE(interpreter.Tostring(tail) == "(3 4)");
+    REQUIRE(interpreter.Evaluate("(list? (list-tail (list 1 2 3) 1))") == BoolObject(true));
+}
@@ -0,0 +1,101 @@
+#include <catch.hpp>
+
+#include <atomic>
+
+#include <loader.h>
+#include <scheme.h>
+
+namespace {
+
+std::vector<std::string> Print(const std::vector<Ref<Object>>& forms) {
+    Interpreter interpreter;
+    std::vector<std::string> printed;
+    for (const auto& form : forms) {
+        printed.push_back(form ? interpreter.Tostring(form) : "()");
+    }
+    return printed;
+}
+
+}  // namespace
+
+TEST_CASE("Thread pool runs every index once") {
+    ThreadPool pool{4};
+    REQUIRE(pool.Size() == 4);
+    std::vector<std::atomic<int>> calls(1000);
+    for (int round = 0; round < 3; ++round) {
+        pool.ParallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+    }
+    for (auto& count : calls) {
+        REQUIRE(count == 3);
+    }
+    pool.ParallelFor(0, [](size_t) { FAIL(); });
+}
+
+TEST_CASE("Top-level forms are split at their boundaries") {
+    using Chunks = std::vector<std::string_view>;
+    REQUIRE(SplitTopLevelForms("(a b) 'c (d (e))  f ", 1) ==
+            Chunks{"(a b)", " 'c", " (d (e))", "  f", " "});
+    REQUIRE(SplitTopLevelForms("' (1) '\n'x", 1) == Chunks{"' (1)", " '\n'x"});
+    REQUIRE(SplitTopLevelForms("(1) (2) (3) (4)", 6) == Chunks{"(1) (2)", " (3) (4)"});
+    REQUIRE(SplitTopLevelForms("(1)) (2", 1) == Chunks{"(1)", ")", " (2"});
+    REQUIRE(SplitTopLevelForms("", 1).empty());
+}
+
+TEST_CASE("Forms read in parallel come back in source order") {
+    std::string source;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 3000; ++i) {
+        std::string form;
+        switch (i % 4) {
+            case 0:
+                form = std::to_string(i);
+                break;
+            case 1:
+                form = "(+ " + std::to_string(i) + " (x y))";
+                break;
+            case 2:
+                form = "'sym" + std::to_string(i);
+                break;
+            default:
+                form = "(1 (2 (3 . " + std::to_string(i) + ")))";
+        }
+        source += form + (i % 7 ? " " : "\n");
+        expected.push_back(Print({ReadAll(form).front()}).front());
+    }
+
+    REQUIRE(Print(ReadAll(source)) == expected);
+    ThreadPool pool{3};
+    for (size_t chunk : {1, 100, 4096, 1 << 20}) {
+        LoadOptions options;
+        options.min_chunk_bytes = chunk;
+        REQUIRE(Print(ReadAll(source, &pool, options)) == expected);
+    }
+}
+
+TEST_CASE("Parallel reading reports the first error") {
+    ThreadPool pool{2};
+    LoadOptions options;
+    options.min_chunk_bytes = 1;
+
+    auto result = TryReadAll("(1) (2 .) (3 4) )", &pool, options);
+    REQUIRE(!result);
+    REQUIRE(result.Error().message == "expected a datum after '.'");
+
+    REQUIRE(TryReadAll("(1) (2", &pool, options).Error().message ==
+            "unexpected end of input");
+    REQUIRE(TryReadAll("(1) '", &pool, options).Error().message ==
+            "quote must be followed by a datum");
+    REQUIRE_THROWS_AS(ReadAll("1 )", &pool, options), SyntaxError);
+    REQUIRE(ReadAll("  \n", &pool, options).empty());
+}
+
+TEST_CASE("Loaded forms live on the heap") {
+    Arena arena;
+    std::vector<Ref<Object>> forms;
+    {
+        ArenaScope scope{&arena};
+        forms = ReadAll("(1 2) (3 4)");
+        REQUIRE(arena.BytesUsed() == 0);
+    }
+    REQUIRE(Print(forms) == Print(ReadAll("(1 2) (3 4)")));
+}
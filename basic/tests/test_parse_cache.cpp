@@ -0,0 +1,154 @@
+#include <catch.hpp>
+
+#include <thread>
+
+#include <parse_cache.h>
+#include <scheme.h>
+
+TEST_CASE("Parse cache counts hits and misses") {
+    ParseCache cache{4};
+    Ref<Object> tree;
+    REQUIRE(!cache.Find("(+ 1 2)", &tree));
+    cache.Insert("(+ 1 2)", MakeObject<Number>(3));
+    REQUIRE(cache.Find("(+ 1 2)", &tree));
+    REQUIRE(As<Number>(tree)->GetValue() == 3);
+
+    cache.Insert("()", nullptr);
+    REQUIRE(cache.Find("()", &tree));
+    REQUIRE(tree == nullptr);
+
+    auto stats = cache.Stats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.size == 2);
+}
+
+TEST_CASE("Parse cache evicts entries that were not used") {
+    ParseCache cache{3};
+    Ref<Object> tree;
+    for (auto source : {"a", "b", "c"}) {
+        cache.Insert(source, nullptr);
+    }
+    REQUIRE(cache.Find("a", &tree));
+    cache.Insert("d", nullptr);
+    REQUIRE(cache.Find("a", &tree));
+    REQUIRE(!cache.Find("b", &tree));
+    REQUIRE(cache.Find("d", &tree));
+
+    for (int i = 0; i < 100; ++i) {
+        cache.Insert(std::to_string(i), nullptr);
+    }
+    auto stats = cache.Stats();
+    REQUIRE(stats.size == cache.Capacity());
+    REQUIRE(stats.evictions == 101);
+}
+
+TEST_CASE("Interpreters share a parse cache") {
+    auto cache = std::make_shared<ParseCache>(16);
+    Interpreter first{InterpreterOptions{.parse_cache = cache}};
+    Interpreter region{InterpreterOptions{.use_region = true, .parse_cache = cache}};
+
+    REQUIRE(first.Run("(+ 1 (* 2 3))") == "7");
+    REQUIRE(region.Run("(+ 1 (* 2 3))") == "7");
+    REQUIRE(region.Run("(+ 1 (* 2 3))") == "7");
+    REQUIRE(first.Run("'(1 2)") == "(1 2)");
+    REQUIRE(region.Run("'(1 2)") == "(1 2)");
+    REQUIRE_THROWS_AS(first.Run("(+ 1"), SyntaxError);
+    REQUIRE_THROWS_AS(first.Run("(+ 1"), SyntaxError);
+
+    auto stats = cache->Stats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.size == 2);
+}
+
+TEST_CASE("Parse cache is safe to use from several threads") {
+    auto cache = std::make_shared<ParseCache>(8);
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4);
+    for (size_t t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([&, t] {
+            Interpreter interpreter{InterpreterOptions{.use_region = t % 2 == 1,
+                                                       .parse_cache = cache}};
+            for (int i = 0; i < 2000; ++i) {
+                int n = i % 12;
+                if (interpreter.Run("(+ " + std::to_string(n) + " 1)") != std::to_string(n + 1)) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(failures == std::vector<int>(4));
+    auto stats = cache->Stats();
+    REQUIRE(stats.hits + stats.misses == 8000);
+    REQUIRE(stats.size == 8);
+}
+
+TEST_CASE("Cached trees can be printed and dropped from several threads") {
+    // Quoted data hands cells of the shared trees to Print() and to new pairs, and the small
+    // cache keeps evicting trees that other threads still hold, so the last reference to a
+    // shared cell is dropped on whichever thread finishes with it last.
+    auto cache = std::make_shared<ParseCache>(2);
+    const std::vector<std::pair<std::string, std::string>> programs = {
+        {"'(1 (2 3) 4)", "(1 (2 3) 4)"},
+        {"(cdr '(a b (c . d)))", "(b (c . d))"},
+        {"(car '((1 2) 3))", "(1 2)"},
+        {"'(x y . z)", "(x y . z)"},
+        {"(cons 0 '((1) 2))", "(0 (1) 2)"},
+    };
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4);
+    for (size_t t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([&, t] {
+            Interpreter interpreter{InterpreterOptions{.parse_cache = cache}};
+            for (int i = 0; i < 2000; ++i) {
+                const auto& [source, expected] = programs[(i + t) % programs.size()];
+                if (interpreter.Run(source) != expected) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(failures == std::vector<int>(4));
+}
+
+TEST_CASE("Results of interpreters sharing a parse cache outlive the cached trees") {
+    // Evaluate() hands out parts of the cached trees. They are kept past eviction and released
+    // on the main thread, after the interpreters that evaluated them are gone.
+    auto cache = std::make_shared<ParseCache>(2);
+    const std::vector<std::pair<std::string, std::string>> programs = {
+        {"'(1 2 3)", "(1 2 3)"},
+        {"(cdr '(a (b) c))", "((b) c)"},
+        {"'((x . y) z)", "((x . y) z)"},
+    };
+    std::vector<std::vector<Ref<Object>>> results(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&, t] {
+            Interpreter interpreter{InterpreterOptions{.use_region = t % 2 == 1,
+                                                       .parse_cache = cache}};
+            for (int i = 0; i < 600; ++i) {
+                const auto& source = programs[(i + t) % programs.size()].first;
+                results[t].push_back(interpreter.Evaluate(source));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Interpreter printer;
+    for (size_t t = 0; t < results.size(); ++t) {
+        for (size_t i = 0; i < results[t].size(); ++i) {
+            const auto& expected = programs[(i + t) % programs.size()].second;
+            REQUIRE(printer.Tostring(results[t][i]) == expected);
+        }
+    }
+    REQUIRE(cache->Stats().evictions > 0);
+    results.clear();
+}
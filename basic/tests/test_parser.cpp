@@ -14,6 +14,15 @@ auto ReadFull(const std::string& str) {
     return obj;
 }
 
+auto ReadFullBulk(const std::string& str) {
+    TokenBuffer tokens = Tokenize(str);
+    size_t pos = 0;
+
+    auto obj = Read(tokens, &pos);
+    REQUIRE(pos == tokens.Size());
+    return obj;
+}
+
 TEST_CASE("Read number") {
     auto node = ReadFull("5");
     REQUIRE(Is<Number>(node));
@@ -154,3 +163,114 @@ TEST_CASE("Invalid") {
     REQUIRE_THROWS_AS(ReadFull("(1 . )"), SyntaxError);
     REQUIRE_THROWS_AS(ReadFull("(1 . 2 3)"), SyntaxError);
 }
+
+TEST_CASE("Read from a token buffer") {
+    auto list = ReadFullBulk("(+ 1 (quote x) . 2)");
+    REQUIRE(Is<Cell>(list));
+    REQUIRE(As<Symbol>(As<Cell>(list)->GetFirst())->GetName() == "+");
+
+    list = As<Cell>(list)->GetSecond();
+    REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == 1);
+
+    list = As<Cell>(list)->GetSecond();
+    auto quote = As<Cell>(As<Cell>(list)->GetFirst());
+    REQUIRE(As<Symbol>(quote->GetFirst())->GetName() == "quote");
+    REQUIRE(As<Number>(As<Cell>(list)->GetSecond())->GetValue() == 2);
+
+    REQUIRE(!ReadFullBulk("()"));
+
+    SECTION("Reads consecutive expressions") {
+        TokenBuffer tokens = Tokenize("1 'a (b)");
+        size_t pos = 0;
+        REQUIRE(Is<Number>(Read(tokens, &pos)));
+        REQUIRE(pos == 1);
+        REQUIRE(Is<Cell>(Read(tokens, &pos)));
+        REQUIRE(pos == 3);
+        REQUIRE(Is<Cell>(Read(tokens, &pos)));
+        REQUIRE(pos == tokens.Size());
+    }
+
+    SECTION("Invalid") {
+        for (auto input : {"", "'", "(", "(1", "(1 .", "( .", "(1 . ()", "(1 . )", "(1 . 2 3)"}) {
+            REQUIRE_THROWS_AS(ReadFullBulk(input), SyntaxError);
+        }
+    }
+}
+
+TEST_CASE("Syntax errors as values") {
+    auto result = TryReadFull("(1 (2 . 3))");
+    REQUIRE(result);
+    REQUIRE(Is<Cell>(result.Value()));
+
+    for (auto input : {"", "'", "(", "(1", "(1 .", "( .", "(1 . ()", "(1 . )", "(1 . 2 3)",
+                       "((1)", ")(1)", "(.)", "(1 .)", "(. 2)", "(a @)", "99999999999999999999"}) {
+        auto error = TryReadFull(input);
+        REQUIRE_FALSE(error);
+        REQUIRE(!error.Error().message.empty());
+    }
+
+    REQUIRE(TryReadFull("(1").Error().message == "unexpected end of input");
+    REQUIRE(TryReadFull("(1 . 2 3)").Error().message == "more than one datum after '.'");
+    REQUIRE_THROWS_AS(std::move(TryReadFull("(1")).ValueOrThrow(), SyntaxError);
+}
+
+TEST_CASE("Deeply nested input") {
+    const size_t depth = 1000000;
+    std::string input = std::string(depth, '(') + "1" + std::string(depth, ')');
+
+    SECTION("Read with a raised limit") {
+        auto result = TryReadFull(input, ReaderOptions{depth});
+        REQUIRE(result);
+        auto node = result.Value();
+        size_t cells = 0;
+        while (Is<Cell>(node)) {
+            node = As<Cell>(node)->GetFirst();
+            ++cells;
+        }
+        REQUIRE(cells == depth);
+        REQUIRE(As<Number>(node)->GetValue() == 1);
+    }
+
+    SECTION("Default limit") {
+        REQUIRE_THROWS_AS(ReadFull(input), SyntaxError);
+        auto error = TryReadFull(input);
+        REQUIRE_FALSE(error);
+        REQUIRE(error.Error().message == "nesting too deep");
+    }
+
+    SECTION("Limit is exact") {
+        REQUIRE(TryReadFull("((1))", ReaderOptions{2}));
+        REQUIRE_FALSE(TryReadFull("(((1)))", ReaderOptions{2}));
+        REQUIRE(TryReadFull("''1", ReaderOptions{2}).Error().message ==
+                "quote must be followed by a datum");
+        REQUIRE_FALSE(TryReadFull("'('(1))", ReaderOptions{3}));
+    }
+}
+
+TEST_CASE("Long lists") {
+    std::string input = "(";
+    for (int i = 0; i < 1000000; ++i) {
+        input += "1 ";
+    }
+    input += ". 2)";
+    auto list = ReadFull(input);
+    size_t length = 0;
+    while (Is<Cell>(list)) {
+        list = As<Cell>(list)->GetSecond();
+        ++length;
+    }
+    REQUIRE(length == 1000000);
+    REQUIRE(As<Number>(list)->GetValue() == 2);
+}
+
+TEST_CASE("Dot and bracket placement") {
+    REQUIRE_THROWS_AS(ReadFull(")"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull(". 1"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull("(1 . . 2)"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull("(1 . 2 ())"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull("(1 . 2 . 3)"), SyntaxError);
+
+    auto quoted = ReadFull("'(1 . 2)");
+    auto datum = As<Cell>(As<Cell>(quoted)->GetSecond())->GetFirst();
+    REQUIRE(As<Number>(As<Cell>(datum)->GetSecond())->GetValue() == 2);
+}
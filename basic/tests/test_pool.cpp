@@ -0,0 +1,119 @@
+#include <catch.hpp>
+
+#include <thread>
+
+#include <loader.h>
+#include <scheme.h>
+
+TEST_CASE("Pooled objects are packed into slabs") {
+    auto before = ObjectPool<Cell>::Stats();
+    std::vector<Ref<Object>> cells;
+    for (int i = 0; i < 10000; ++i) {
+        cells.push_back(MakeObject<Cell>());
+    }
+    auto during = ObjectPool<Cell>::Stats();
+    REQUIRE(during.object_size == sizeof(Cell));
+    REQUIRE(during.live == before.live + 10000);
+    REQUIRE(during.slabs >= 10000 * sizeof(Cell) / SlabPool::kSlabBytes);
+    REQUIRE(during.Occupancy() > 0);
+    REQUIRE(during.Occupancy() <= 1);
+
+    cells.clear();
+    REQUIRE(ObjectPool<Cell>::Stats().live == before.live);
+    REQUIRE(ObjectPool<Cell>::Stats().slabs == during.slabs);
+
+    // The second round runs on the free slots.
+    for (int i = 0; i < 10000; ++i) {
+        cells.push_back(MakeObject<Cell>());
+    }
+    REQUIRE(ObjectPool<Cell>::Stats().slabs == during.slabs);
+}
+
+TEST_CASE("Freed slots are reused") {
+    const Object* first = MakeObject<Number>(1).get();
+    auto second = MakeObject<Number>(2);
+    REQUIRE(second.get() == first);
+}
+
+TEST_CASE("Objects may be freed on another thread") {
+    auto before = ObjectPool<Symbol>::Stats().live;
+    std::vector<Ref<Object>> symbols;
+    std::thread producer{[&] {
+        for (int i = 0; i < 1000; ++i) {
+            symbols.push_back(MakeObject<Symbol>("x"));
+        }
+    }};
+    producer.join();
+    REQUIRE(ObjectPool<Symbol>::Stats().live == before + 1000);
+    symbols.clear();
+    REQUIRE(ObjectPool<Symbol>::Stats().live == before);
+
+    // The exited thread's pool, with its free slots, goes to the next thread.
+    std::thread consumer{[] {
+        for (int i = 0; i < 100; ++i) {
+            MakeObject<Symbol>("y");
+        }
+    }};
+    consumer.join();
+    REQUIRE(ObjectPool<Symbol>::Stats().live == before);
+}
+
+TEST_CASE("Runs are adjacent slots") {
+    size_t count = 0;
+    auto* run = static_cast<std::byte*>(ObjectPool<Cell>::AllocateRun(4, &count));
+    REQUIRE(count >= 1);
+    REQUIRE(count <= 4);
+    for (size_t i = 0; i < count; ++i) {
+        ObjectPool<Cell>::Free(run + i * sizeof(Cell));
+    }
+
+    // The slots just freed come back as one run, in whichever order they were freed.
+    size_t again = 0;
+    REQUIRE(ObjectPool<Cell>::AllocateRun(count, &again) == run);
+    REQUIRE(again == count);
+    for (size_t i = count; i > 0; --i) {
+        ObjectPool<Cell>::Free(run + (i - 1) * sizeof(Cell));
+    }
+}
+
+TEST_CASE("Objects freed late in thread exit go back to the registry") {
+    struct Holder {
+        std::vector<Ref<Object>> symbols;
+    };
+    auto before = ObjectPool<Symbol>::Stats().live;
+    // The holder is constructed before the thread's pool, so it is destroyed after the pool
+    // went back to the registry, while other threads may already be using that pool.
+    auto exiting = [] {
+        thread_local Holder holder;
+        for (int i = 0; i < 100; ++i) {
+            holder.symbols.push_back(MakeObject<Symbol>("z"));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back(exiting);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(ObjectPool<Symbol>::Stats().live == before);
+}
+
+TEST_CASE("Slots freed on another thread go back to the pool that owns them") {
+    std::string source;
+    for (int i = 0; i < 1000; ++i) {
+        source += "(define (f x) (if (< x 2) x (+ (f (- x 1)) (f (- x 2))))) '(1 2 3 4 5 6 7) ";
+    }
+    // The workers build the trees and this thread frees them.
+    auto read = [&] {
+        ThreadPool threads{4};
+        ReadAll(source, &threads);
+    };
+    read();
+    auto slabs = ObjectPool<Cell>::Stats().slabs;
+    for (int round = 0; round < 10; ++round) {
+        read();
+    }
+    // Every thread may have started on a slab of its own.
+    REQUIRE(ObjectPool<Cell>::Stats().slabs <= slabs + 4);
+}
@@ -0,0 +1,50 @@
+#include <catch.hpp>
+
+#include <thread>
+
+#include <scheme.h>
+#include <symbol_table.h>
+
+TEST_CASE("Interning returns one entry per name") {
+    auto& table = SymbolTable::Global();
+    auto first = table.Intern("interned-name");
+    REQUIRE(table.Intern(std::string("interned-") + "name") == first);
+    REQUIRE(table.Find("interned-name") == first);
+    REQUIRE(table.Get(first->id) == first);
+    REQUIRE(table.Find("never-interned-name") == nullptr);
+
+    REQUIRE(table.Get(BuiltinSymbol::CAR)->name == "car");
+    REQUIRE(table.Intern("car")->id == ToId(BuiltinSymbol::CAR));
+    REQUIRE(Symbol{"#t"}.Matches(BuiltinSymbol::BOOL_TRUE));
+}
+
+TEST_CASE("Interning from several threads") {
+    std::vector<const InternedSymbol*> seen(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        threads.emplace_back([&seen, i] {
+            for (int j = 0; j < 1000; ++j) {
+                SymbolTable::Global().Intern("threaded-" + std::to_string(j));
+            }
+            seen[i] = SymbolTable::Global().Intern("threaded-999");
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto symbol : seen) {
+        REQUIRE(symbol == seen[0]);
+    }
+}
+
+TEST_CASE("Printed results do not grow the table") {
+    Interpreter interpreter;
+    interpreter.Run("(list 1 2 3)");
+    auto size = SymbolTable::Global().Size();
+    for (int i = 0; i < 100; ++i) {
+        interpreter.Run("(list " + std::to_string(i) + " 1)");
+    }
+    REQUIRE(SymbolTable::Global().Size() == size);
+
+    REQUIRE(interpreter.Run("(not (car '(#f)))") == "#t");
+}
@@ -153,3 +153,211 @@ TEST_CASE("Empty string handled correctly") {
 
     REQUIRE(tokenizer.IsEnd());
 }
+
+TEST_CASE("Tokenizer over a memory buffer") {
+    std::string input = "(foo -2 - +7)\n'bar . ";
+    Tokenizer tokenizer{std::string_view(input)};
+
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::OPEN});
+
+    tokenizer.Next();
+    auto token = tokenizer.GetToken();
+    REQUIRE(token == Token{SymbolToken{"foo"}});
+    // Symbols point straight into the source instead of owning a copy.
+    REQUIRE(std::get<SymbolToken>(token).name.data() == input.data() + 1);
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{-2}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"-"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{7}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{QuoteToken{}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"bar"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{DotToken{}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+}
+
+TEST_CASE("Buffer tokenizer takes a raw range") {
+    const char data[] = "12 zog-zog? +";
+    Tokenizer tokenizer{data, sizeof(data) - 1};
+
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{12}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"zog-zog?"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"+"}});
+
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    Tokenizer empty{std::string_view("  \n ")};
+    REQUIRE(empty.IsEnd());
+}
+
+TEST_CASE("Long runs do not grow the stack") {
+    std::string spaces(100000, ' ');
+    std::string symbol(100000, 'a');
+    std::string input = spaces + symbol + spaces + "\t\r\n12";
+
+    SECTION("Buffer") {
+        Tokenizer tokenizer{std::string_view(input)};
+        REQUIRE(tokenizer.GetToken() == Token{SymbolToken{symbol}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{ConstantToken{12}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.IsEnd());
+    }
+
+    SECTION("Stream") {
+        std::stringstream ss{input};
+        Tokenizer tokenizer{&ss};
+        REQUIRE(tokenizer.GetToken() == Token{SymbolToken{symbol}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{ConstantToken{12}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.IsEnd());
+    }
+}
+
+TEST_CASE("Unknown characters are syntax errors") {
+    REQUIRE_THROWS_AS(Tokenizer{std::string_view("@")}, SyntaxError);
+    REQUIRE_THROWS_AS(Tokenizer{std::string_view("?a")}, SyntaxError);
+
+    Tokenizer tokenizer{std::string_view("abc[")};
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"abc"}});
+    REQUIRE_THROWS_AS(tokenizer.Next(), SyntaxError);
+}
+
+TEST_CASE("Bulk tokenization") {
+    std::string input = " (foo -12 . 'bar)";
+    TokenBuffer tokens = Tokenize(input);
+
+    REQUIRE(tokens.Size() == 7);
+    REQUIRE(tokens.kinds == std::vector<TokenKind>{TokenKind::OPEN, TokenKind::SYMBOL,
+                                                   TokenKind::CONSTANT, TokenKind::DOT,
+                                                   TokenKind::QUOTE, TokenKind::SYMBOL,
+                                                   TokenKind::CLOSE});
+    REQUIRE(tokens.offsets == std::vector<uint32_t>{1, 2, 6, 10, 12, 13, 16});
+    REQUIRE(tokens.lengths == std::vector<uint32_t>{1, 3, 3, 1, 1, 3, 1});
+    REQUIRE(tokens.values[2] == -12);
+    REQUIRE(tokens.Text(1) == "foo");
+    REQUIRE(tokens.Text(5) == "bar");
+
+    REQUIRE(Tokenize("  \n").Size() == 0);
+    REQUIRE_THROWS_AS(Tokenize("(a @)"), SyntaxError);
+}
+
+namespace {
+
+std::vector<std::string> Describe(const std::vector<Token>& tokens) {
+    std::vector<std::string> result;
+    for (const auto& token : tokens) {
+        if (auto symbol = std::get_if<SymbolToken>(&token)) {
+            result.emplace_back(symbol->name);
+        } else if (auto constant = std::get_if<ConstantToken>(&token)) {
+            result.push_back("#" + std::to_string(constant->value));
+        } else {
+            result.push_back("kind " + std::to_string(token.index()));
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> TokenizeInChunks(const std::string& input, size_t chunk_size) {
+    ChunkedTokenizer tokenizer;
+    std::vector<std::string> names;
+    Token token;
+    for (size_t pos = 0; pos < input.size(); pos += chunk_size) {
+        tokenizer.Feed(std::string_view(input).substr(pos, chunk_size));
+        // Symbol views only live until the next Poll(), so describe them right away.
+        while (tokenizer.Poll(&token)) {
+            names.push_back(Describe({token})[0]);
+        }
+    }
+    tokenizer.Finish();
+    while (tokenizer.Poll(&token)) {
+        names.push_back(Describe({token})[0]);
+    }
+    REQUIRE(tokenizer.IsEnd());
+    return names;
+}
+
+}  // namespace
+
+TEST_CASE("Chunked tokenizer") {
+    std::string input = "(define-rule foo-bar? (+ -12 345678 - x)) '(a . b)   zog";
+    std::vector<Token> expected;
+    Tokenizer tokenizer{std::string_view(input)};
+    for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+        expected.push_back(tokenizer.GetToken());
+    }
+    auto expected_names = Describe(expected);
+
+    for (size_t chunk_size = 1; chunk_size <= input.size(); ++chunk_size) {
+        REQUIRE(TokenizeInChunks(input, chunk_size) == expected_names);
+    }
+}
+
+TEST_CASE("Chunked tokenizer yields tokens as soon as they are complete") {
+    ChunkedTokenizer tokenizer;
+    Token token;
+
+    tokenizer.Feed("(ab");
+    REQUIRE(tokenizer.Poll(&token));
+    REQUIRE(token == Token{BracketToken::OPEN});
+    REQUIRE(!tokenizer.Poll(&token));
+
+    tokenizer.Feed("c 1");
+    REQUIRE(tokenizer.Poll(&token));
+    REQUIRE(token == Token{SymbolToken{"abc"}});
+    REQUIRE(!tokenizer.Poll(&token));
+
+    tokenizer.Feed("2");
+    REQUIRE(!tokenizer.Poll(&token));
+    tokenizer.Finish();
+    REQUIRE(tokenizer.Poll(&token));
+    REQUIRE(token == Token{ConstantToken{12}});
+    REQUIRE(!tokenizer.Poll(&token));
+    REQUIRE(tokenizer.IsEnd());
+}
+
+TEST_CASE("64-bit integer literals") {
+    auto constant = [](std::string_view input) {
+        Tokenizer tokenizer{input};
+        return std::get<ConstantToken>(tokenizer.GetToken()).value;
+    };
+
+    REQUIRE(constant("0") == 0);
+    REQUIRE(constant("-0") == 0);
+    REQUIRE(constant("12345678") == 12345678);
+    REQUIRE(constant("123456789012") == 123456789012);
+    REQUIRE(constant("+4294967296") == 4294967296);
+    REQUIRE(constant("000000000000000000000042") == 42);
+    REQUIRE(constant("9223372036854775807") == std::numeric_limits<int64_t>::max());
+    REQUIRE(constant("-9223372036854775808") == std::numeric_limits<int64_t>::min());
+
+    REQUIRE_THROWS_AS(constant("9223372036854775808"), SyntaxError);
+    REQUIRE_THROWS_AS(constant("-9223372036854775809"), SyntaxError);
+    REQUIRE_THROWS_AS(constant("18446744073709551616"), SyntaxError);
+    REQUIRE_THROWS_AS(Tokenize("(1 99999999999999999999)"), SyntaxError);
+
+    std::stringstream ss{"-9223372036854775808"};
+    Tokenizer tokenizer{&ss};
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{std::numeric_limits<int64_t>::min()}});
+}
@@ -0,0 +1,155 @@
+#include <catch.hpp>
+
+#include <thread>
+
+#include <scheme.h>
+
+#include "scheme_test.h"
+
+TEST_CASE("Fixnums round-trip") {
+    for (int64_t number : {int64_t{0}, int64_t{1}, int64_t{-1}, int64_t{42}, Value::kMinFixnum,
+                           Value::kMaxFixnum}) {
+        Value value = Value::Fixnum(number);
+        REQUIRE(value.IsFixnum());
+        REQUIRE(value.IsNumber());
+        REQUIRE_FALSE(value.IsHeap());
+        REQUIRE(value.GetFixnum() == number);
+        REQUIRE(value.GetNumber() == number);
+    }
+    REQUIRE_FALSE(Value::FitsFixnum(Value::kMaxFixnum + 1));
+    REQUIRE_FALSE(Value::FitsFixnum(Value::kMinFixnum - 1));
+}
+
+TEST_CASE("Immediates are distinct") {
+    REQUIRE(Value::Bool(true).IsTrue());
+    REQUIRE(Value::Bool(false).IsFalse());
+    REQUIRE(Value::Nil().IsNil());
+    REQUIRE_FALSE(Value::Nil().IsBool());
+    REQUIRE_FALSE(Value::Bool(false).IsNumber());
+    REQUIRE_FALSE(Value::Fixnum(0).IsFalse());
+    REQUIRE(Value().IsNull());
+}
+
+TEST_CASE("Objects convert to values and back") {
+    auto small = MakeHeapObject<Number>(7);
+    REQUIRE(ToValue(small) == Value::Fixnum(7));
+    REQUIRE(As<Number>(ToObject(ToValue(small)))->GetValue() == 7);
+
+    auto big = MakeHeapObject<Number>(INT64_MAX);
+    Value boxed = ToValue(big);
+    REQUIRE(boxed.IsBoxed());
+    REQUIRE(boxed.GetNumber() == INT64_MAX);
+    REQUIRE(ToObject(boxed) == big);
+
+    REQUIRE(ToValue(MakeHeapObject<Symbol>("#t")).IsTrue());
+    REQUIRE(ToValue(MakeHeapObject<Symbol>("#f")).IsFalse());
+    REQUIRE(ToValue(MakeHeapObject<Symbol>("()")).IsNil());
+    Value name = ToValue(MakeHeapObject<Symbol>("foo"));
+    REQUIRE(name.IsSymbol());
+    REQUIRE(As<Symbol>(ToObject(name))->GetName() == "foo");
+
+    auto cell = MakeHeapObject<Cell>();
+    Value heap = ToValue(cell);
+    REQUIRE(heap.IsHeap());
+    REQUIRE(ToObject(heap) == cell);
+}
+
+TEST_CASE_METHOD(SchemeTest, "IntegersOutsideFixnumRange") {
+    ExpectEq("9223372036854775807", "9223372036854775807");
+    ExpectEq("(- 9223372036854775807 1)", "9223372036854775806");
+    ExpectEq("(+ 4611686018427387903 1)", "4611686018427387904");
+    ExpectEq("(= 9223372036854775807 9223372036854775807)", "#t");
+    ExpectEq("(max 1 9223372036854775807)", "9223372036854775807");
+    ExpectEq("(and 1 9223372036854775807)", "9223372036854775807");
+}
+
+TEST_CASE("Type tags drive Is and As") {
+    Ref<Object> number = MakeHeapObject<Number>(1);
+    Ref<Object> symbol = MakeHeapObject<Symbol>("x");
+    Ref<Object> cell = MakeHeapObject<Cell>();
+    REQUIRE(number->GetType() == ObjectType::NUMBER);
+    REQUIRE(symbol->GetType() == ObjectType::SYMBOL);
+    REQUIRE(cell->GetType() == ObjectType::CELL);
+
+    REQUIRE(Is<Number>(number));
+    REQUIRE_FALSE(Is<Symbol>(number));
+    REQUIRE_FALSE(Is<Cell>(Ref<Object>()));
+    REQUIRE(As<Cell>(cell) == cell.get());
+    REQUIRE(As<Cell>(symbol) == nullptr);
+
+    // As borrows: no reference is taken.
+    auto count = symbol.use_count();
+    REQUIRE(As<Symbol>(symbol)->GetName() == "x");
+    REQUIRE(symbol.use_count() == count);
+}
+
+TEST_CASE("References are counted in the object") {
+    Ref<Object> cell = MakeObject<Cell>();
+    REQUIRE(cell.use_count() == 1);
+    {
+        Ref<Object> copy = cell;
+        REQUIRE(cell.use_count() == 2);
+        Ref<Cell> typed{As<Cell>(copy)};
+        REQUIRE(cell.use_count() == 3);
+        REQUIRE(typed == cell);
+    }
+    REQUIRE(cell.use_count() == 1);
+
+    Ref<Object> moved = std::move(cell);
+    REQUIRE(cell == nullptr);
+    REQUIRE(moved.use_count() == 1);
+}
+
+TEST_CASE("Shared trees count atomically") {
+    auto tree = Interpreter{}.ReadFull("(1 (2 3) x)");
+    REQUIRE_FALSE(tree->IsShared());
+    ShareAcrossThreads(tree);
+    REQUIRE(tree->IsShared());
+    auto inner = As<Cell>(As<Cell>(tree)->GetSecond())->GetFirst();
+    REQUIRE(inner->IsShared());
+    REQUIRE(As<Cell>(inner)->GetFirst()->IsShared());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                Ref<Object> copy = inner;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(inner.use_count() == 2);
+}
+
+TEST_CASE("Booleans, () and small integers are immortal") {
+    REQUIRE(BoolObject(true) == BoolObject(true));
+    REQUIRE(BoolObject(true) != BoolObject(false));
+    REQUIRE(BoolObject(false)->IsImmortal());
+    REQUIRE(As<Symbol>(EmptyListObject())->GetName() == "()");
+    REQUIRE(ToObject(Value::Bool(true)) == BoolObject(true));
+    REQUIRE(ToObject(Value::Nil()) == EmptyListObject());
+
+    REQUIRE(NumberObject(kMinCachedNumber) == NumberObject(kMinCachedNumber));
+    REQUIRE(NumberObject(kMaxCachedNumber) == ToObject(Value::Fixnum(kMaxCachedNumber)));
+    REQUIRE(NumberObject(kMaxCachedNumber + 1) != NumberObject(kMaxCachedNumber + 1));
+    REQUIRE(As<Number>(NumberObject(-7))->GetValue() == -7);
+
+    // The reader uses them too.
+    auto tree = Interpreter{}.ReadFull("(#t 7 x)");
+    REQUIRE(As<Cell>(tree)->GetFirst() == BoolObject(true));
+    REQUIRE(As<Cell>(As<Cell>(tree)->GetSecond())->GetFirst() == NumberObject(7));
+}
+
+TEST_CASE("Predicate results allocate nothing") {
+    Interpreter interpreter;
+    auto tree = interpreter.ReadFull("(and (< 1 2 3) (number? 5) (not #f) (= 4 4))");
+    auto symbols = ObjectPool<Symbol>::Stats().live;
+    auto numbers = ObjectPool<Number>::Stats().live;
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(interpreter.Eval(tree) == BoolObject(true));
+    }
+    REQUIRE(ObjectPool<Symbol>::Stats().live == symbols);
+    REQUIRE(ObjectPool<Number>::Stats().live == numbers);
+}
@@ -0,0 +1,77 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::Size() const {
+    return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body) {
+    std::lock_guard run_lock{run_mutex_};
+    if (workers_.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard lock{mutex_};
+        body_ = &body;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        busy_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+    RunTasks();
+
+    std::unique_lock lock{mutex_};
+    done_.wait(lock, [this] { return busy_ == 0; });
+    body_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        RunTasks();
+        std::lock_guard lock{mutex_};
+        if (--busy_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunTasks() {
+    for (size_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+        (*body_)(i);
+    }
+}
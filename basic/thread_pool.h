@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+class ThreadPool {
+public:
+    // `threads` counts the calling thread, which takes part in every loop. 0 picks the
+    // number of hardware threads.
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t Size() const;
+
+    // Calls `body(i)` for every i in [0, count) and returns once all calls are done. Calls run
+    // concurrently and in no particular order; `body` must not throw. Loops started from
+    // several threads at once run one after another.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void WorkerLoop();
+    void RunTasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    size_t busy_ = 0;
+    bool stop_ = false;
+
+    const std::function<void(size_t)>* body_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{0};
+};
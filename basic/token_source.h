@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <variant>
+
+#include "tokenizer.h"
+
+// The readers are written against a token source with IsEnd/Kind/Value/Text/Next, so the
+// same code walks a streaming Tokenizer and a bulk TokenBuffer. Kind() is END past the input.
+enum class SourceKind { CONSTANT, OPEN, CLOSE, SYMBOL, QUOTE, DOT, END };
+
+class TokenizerSource {
+public:
+    explicit TokenizerSource(Tokenizer* tokenizer) : tokenizer_(tokenizer) {
+        Load();
+    }
+
+    bool IsEnd() const {
+        return tokenizer_->IsEnd();
+    }
+
+    SourceKind Kind() const {
+        return kind_;
+    }
+
+    int64_t Value() const {
+        return std::get<ConstantToken>(token_).value;
+    }
+
+    std::string_view Text() const {
+        return std::get<SymbolToken>(token_).name;
+    }
+
+    void Next() {
+        tokenizer_->Next();
+        Load();
+    }
+
+private:
+    struct KindOf {
+        SourceKind operator()(const ConstantToken&) const {
+            return SourceKind::CONSTANT;
+        }
+        SourceKind operator()(BracketToken bracket) const {
+            return bracket == BracketToken::OPEN ? SourceKind::OPEN : SourceKind::CLOSE;
+        }
+        SourceKind operator()(const SymbolToken&) const {
+            return SourceKind::SYMBOL;
+        }
+        SourceKind operator()(const QuoteToken&) const {
+            return SourceKind::QUOTE;
+        }
+        SourceKind operator()(const DotToken&) const {
+            return SourceKind::DOT;
+        }
+    };
+
+    void Load() {
+        token_ = tokenizer_->GetToken();
+        kind_ = tokenizer_->IsEnd() ? SourceKind::END : std::visit(KindOf{}, token_);
+    }
+
+    Tokenizer* tokenizer_;
+    Token token_;
+    SourceKind kind_;
+};
+
+class BufferSource {
+public:
+    BufferSource(const TokenBuffer& tokens, size_t pos) : tokens_(tokens), pos_(pos) {
+    }
+
+    bool IsEnd() const {
+        return pos_ >= tokens_.Size();
+    }
+
+    SourceKind Kind() const {
+        return IsEnd() ? SourceKind::END : static_cast<SourceKind>(tokens_.kinds[pos_]);
+    }
+
+    int64_t Value() const {
+        return tokens_.values[pos_];
+    }
+
+    std::string_view Text() const {
+        return tokens_.Text(pos_);
+    }
+
+    void Next() {
+        ++pos_;
+    }
+
+    size_t Pos() const {
+        return pos_;
+    }
+
+private:
+    const TokenBuffer& tokens_;
+    size_t pos_;
+};
+
+static_assert(static_cast<int>(SourceKind::DOT) == static_cast<int>(TokenKind::DOT));
@@ -1,5 +1,245 @@
 #include <tokenizer.h>
+#include <bit>
+#include <cstring>
 #include <iostream>
+#include <limits>
+
+#include "char_class.h"
+#include "error.h"
+
+namespace {
+
+// The lexer is a DFA over character classes. Both tables are built at compile time, and
+// Tokenizer::Next() runs it in a single loop until it reaches one of the EMIT_* states.
+enum LexClass : uint8_t {
+    OTHER,
+    SPACE,
+    DIGIT,
+    START_SYMBOL,
+    SYMBOL,  // may continue a symbol but not start one
+    MINUS,
+    PLUS,
+    OPEN,
+    CLOSE,
+    QUOTE,
+    DOT,
+    END,
+    LEX_CLASS_COUNT
+};
+
+enum LexState : uint8_t {
+    START,
+    SIGN,
+    IN_SYMBOL,
+    IN_NUMBER,
+    RUNNING_STATE_COUNT,
+    EMIT_SYMBOL = RUNNING_STATE_COUNT,
+    EMIT_NUMBER,
+    EMIT_OPEN,
+    EMIT_CLOSE,
+    EMIT_QUOTE,
+    EMIT_DOT,
+    EMIT_END,
+    LEX_ERROR
+};
+
+struct Transition {
+    LexState next = LEX_ERROR;
+    // Whether the character is part of the current token. Multi-character tokens end on a
+    // character they do not consume, which the next call starts from.
+    bool consume = false;
+};
+
+using TransitionTable = std::array<std::array<Transition, LEX_CLASS_COUNT>, RUNNING_STATE_COUNT>;
+
+constexpr std::array<LexClass, 256> MakeLexClasses() {
+    std::array<LexClass, 256> classes{};
+    for (int c = 0; c < 256; ++c) {
+        if (kCharClassTable[c] & kSpaceBit) {
+            classes[c] = SPACE;
+        } else if (kCharClassTable[c] & kDigitBit) {
+            classes[c] = DIGIT;
+        } else if (kCharClassTable[c] & kStartSymbolBit) {
+            classes[c] = START_SYMBOL;
+        } else if (kCharClassTable[c] & kSymbolBit) {
+            classes[c] = SYMBOL;
+        }
+    }
+    classes['-'] = MINUS;
+    classes['+'] = PLUS;
+    classes['('] = OPEN;
+    classes[')'] = CLOSE;
+    classes['\''] = QUOTE;
+    classes['.'] = DOT;
+    return classes;
+}
+
+constexpr TransitionTable MakeTransitions() {
+    TransitionTable table{};
+
+    auto& start = table[START];
+    start[SPACE] = {START, true};
+    start[DIGIT] = {IN_NUMBER, true};
+    start[START_SYMBOL] = {IN_SYMBOL, true};
+    start[MINUS] = start[PLUS] = {SIGN, true};
+    start[OPEN] = {EMIT_OPEN, true};
+    start[CLOSE] = {EMIT_CLOSE, true};
+    start[QUOTE] = {EMIT_QUOTE, true};
+    start[DOT] = {EMIT_DOT, true};
+    start[END] = {EMIT_END, false};
+
+    // A lone sign is a symbol, a sign followed by digits is a number.
+    for (auto& transition : table[SIGN]) {
+        transition = {EMIT_SYMBOL, false};
+    }
+    table[SIGN][DIGIT] = {IN_NUMBER, true};
+
+    for (auto& transition : table[IN_SYMBOL]) {
+        transition = {EMIT_SYMBOL, false};
+    }
+    for (auto cls : {DIGIT, START_SYMBOL, SYMBOL, MINUS}) {
+        table[IN_SYMBOL][cls] = {IN_SYMBOL, true};
+    }
+
+    for (auto& transition : table[IN_NUMBER]) {
+        transition = {EMIT_NUMBER, false};
+    }
+    table[IN_NUMBER][DIGIT] = {IN_NUMBER, true};
+
+    return table;
+}
+
+constexpr std::array<LexClass, 256> kLexClasses = MakeLexClasses();
+constexpr TransitionTable kTransitions = MakeTransitions();
+
+static_assert(kLexClasses['?'] == SYMBOL && kTransitions[START][SYMBOL].next == LEX_ERROR);
+static_assert(kTransitions[IN_SYMBOL][SYMBOL].next == IN_SYMBOL);
+
+// Runs the DFA over [*pos, end) from `state`. Leaves `*pos` past the consumed bytes and
+// `*begin` at the first byte of the token. If `last` is false the range is only a prefix of
+// the input, and running out of it returns the running state instead of seeing END.
+LexState LexBuffer(LexState state, const char** pos, const char* end, const char** begin,
+                   bool last = true) {
+    const CharScanner& scanner = GetCharScanner();
+    const char* cur = *pos;
+    *begin = cur;
+    while (state < RUNNING_STATE_COUNT) {
+        if (cur == end && !last) {
+            break;
+        }
+        LexClass cls = cur != end ? kLexClasses[static_cast<uint8_t>(*cur)] : END;
+        const Transition& transition = kTransitions[state][cls];
+        if (transition.consume) {
+            ++cur;
+            // Self-loops over whitespace, symbol and digit runs are taken in bulk.
+            if (transition.next == START) {
+                cur = scanner.skip_spaces(cur, end);
+                *begin = cur;
+            } else if (transition.next == IN_SYMBOL) {
+                cur = scanner.skip_symbol(cur, end);
+            } else if (transition.next == IN_NUMBER) {
+                cur = scanner.skip_digits(cur, end);
+            }
+        }
+        state = transition.next;
+    }
+    *pos = cur;
+    return state;
+}
+
+// Same DFA over a streambuf, one byte at a time. The token text is collected in `*lexeme`.
+LexState LexStream(std::streambuf* buf, std::string* lexeme) {
+    lexeme->clear();
+    LexState state = START;
+    while (state < RUNNING_STATE_COUNT) {
+        int elem = buf->sgetc();
+        LexClass cls = elem == EOF ? END : kLexClasses[elem];
+        const Transition& transition = kTransitions[state][cls];
+        if (transition.consume) {
+            buf->sbumpc();
+            if (transition.next != START) {
+                lexeme->push_back(static_cast<char>(elem));
+            }
+        }
+        state = transition.next;
+    }
+    return state;
+}
+
+// Value of eight ASCII digits loaded as one little-endian word, combined pairwise in-register.
+uint64_t ParseEightDigits(const char* digits) {
+    uint64_t word;
+    std::memcpy(&word, digits, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+        word = __builtin_bswap64(word);
+    }
+    word -= 0x3030303030303030;
+    word = word * 10 + (word >> 8);
+    constexpr uint64_t kMask = 0x000000FF000000FF;
+    constexpr uint64_t kMul1 = 100 + (1000000ULL << 32);
+    constexpr uint64_t kMul2 = 1 + (10000ULL << 32);
+    return (((word & kMask) * kMul1) + (((word >> 16) & kMask) * kMul2)) >> 32;
+}
+
+// `text` is an optional sign followed by digits, exactly as the DFA accepts it. Returns false
+// if the value does not fit into int64_t.
+bool ParseConstant(std::string_view text, int64_t* value) {
+    bool negative = text.front() == '-';
+    if (text.front() == '-' || text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    while (text.size() > 1 && text.front() == '0') {
+        text.remove_prefix(1);
+    }
+    // Any 19 digits fit into uint64_t, so only the final range check can fail.
+    if (text.size() > 19) {
+        return false;
+    }
+    const char* digit = text.data();
+    const char* end = digit + text.size();
+    uint64_t magnitude = 0;
+    for (; end - digit >= 8; digit += 8) {
+        magnitude = magnitude * 100000000 + ParseEightDigits(digit);
+    }
+    for (; digit != end; ++digit) {
+        magnitude = magnitude * 10 + (*digit - '0');
+    }
+
+    constexpr uint64_t kMax = std::numeric_limits<int64_t>::max();
+    if (magnitude > kMax + negative) {
+        return false;
+    }
+    *value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+const char kLiteralOutOfRange[] = "integer literal out of range";
+
+Token MakeToken(LexState state, std::string_view text) {
+    switch (state) {
+        case EMIT_SYMBOL:
+            return Token{SymbolToken{text}};
+        case EMIT_NUMBER: {
+            int64_t value;
+            if (!ParseConstant(text, &value)) {
+                throw SyntaxError(kLiteralOutOfRange);
+            }
+            return Token{ConstantToken{value}};
+        }
+        case EMIT_OPEN:
+            return Token{BracketToken::OPEN};
+        case EMIT_CLOSE:
+            return Token{BracketToken::CLOSE};
+        case EMIT_QUOTE:
+            return Token{QuoteToken{}};
+        case EMIT_DOT:
+            return Token{DotToken{}};
+        default:
+            throw SyntaxError("syntax error");
+    }
+}
+
+}  // namespace
 
 bool SymbolToken::operator==(const SymbolToken& other) const {
     if (name == other.name) {
@@ -28,84 +268,159 @@ Tokenizer::Tokenizer(std::istream* in) {
     Next();
 }
 
+Tokenizer::Tokenizer(std::string_view source) : Tokenizer(source.data(), source.size()) {
+}
+
+Tokenizer::Tokenizer(const char* data, size_t size) {
+    pos_ = data;
+    end_ = data + size;
+    Next();
+}
+
 bool Tokenizer::IsNumber(const char& elem) {
-    if (elem >= 48 && elem <= 57) {
-        return true;
-    }
-    return false;
+    return HasCharClass(elem, kDigitBit);
 }
+
 bool Tokenizer::IsStartSymbol(const char& elem) {
-    if ((elem >= 65 && elem <= 90) || (elem >= 97 && elem <= 122) || (elem >= 60 && elem <= 62) ||
-        elem == 42 || elem == 47 || elem == 35) {
-        return true;
-    }
-    return false;
+    return HasCharClass(elem, kStartSymbolBit);
 }
 
 bool Tokenizer::IsSymbol(const char& elem) {
-    if (IsStartSymbol(elem) || IsNumber(elem) || elem == 63 || elem == 33 || elem == 45) {
-        return true;
-    }
-    return false;
+    return HasCharClass(elem, kSymbolBit);
 }
 
 bool Tokenizer::IsEnd() {
-    if (cur_char_ == EOF) {
-        return true;
-    }
-    return false;
+    return at_end_;
 }
+
 void Tokenizer::Next() {
-    char elem = in_->get();
-    cur_char_ = elem;
-    if (!IsEnd()) {
-        if (IsStartSymbol(elem) && cur_symbol_.empty()) {
-            cur_symbol_ += elem;
-            if (IsSymbol(in_->peek())) {
-                Next();
-            } else {
-                token_ = Token{SymbolToken{cur_symbol_}};
-                cur_symbol_.clear();
-            }
-        } else if (IsSymbol(elem) && !cur_symbol_.empty()) {
-            cur_symbol_ += elem;
-            if (IsSymbol(in_->peek())) {
-                Next();
-            } else {
-                token_ = Token{SymbolToken{cur_symbol_}};
-                cur_symbol_.clear();
-            }
-        } else if ((elem == 45 || elem == 43) && cur_symbol_.empty()) {
-            if (IsNumber(in_->peek())) {
-                cur_const_ += elem;
-                Next();
-            } else {
-                cur_symbol_ += elem;
-                token_ = Token{SymbolToken{cur_symbol_}};
-                cur_symbol_.clear();
-            }
-        } else if (IsNumber(elem)) {
-            if (IsNumber(in_->peek())) {
-                cur_const_ += elem;
-                Next();
-            } else {
-                cur_const_ += elem;
-                token_ = Token{ConstantToken{std::stoi(cur_const_)}};
-                cur_const_.clear();
-            }
-        } else if (elem == 39) {
-            token_ = Token{QuoteToken{}};
-        } else if (elem == 46) {
-            token_ = DotToken{};
-        } else if (elem == 41) {
-            token_ = Token{BracketToken::CLOSE};
-        } else if (elem == 40) {
-            token_ = Token{BracketToken::OPEN};
-        } else if (elem == 32 || elem == 10) {
-            Next();
-        }
+    LexState state;
+    std::string_view text;
+    if (in_) {
+        state = LexStream(in_->rdbuf(), &lexeme_);
+        text = lexeme_;
+    } else {
+        const char* begin;
+        state = LexBuffer(START, &pos_, end_, &begin);
+        text = std::string_view(begin, pos_ - begin);
+    }
+
+    if (state == EMIT_END) {
+        at_end_ = true;
+    } else {
+        token_ = MakeToken(state, text);
     }
 }
+
 Token Tokenizer::GetToken() {
     return token_;
 }
+
+size_t TokenBuffer::Size() const {
+    return kinds.size();
+}
+
+std::string_view TokenBuffer::Text(size_t index) const {
+    return source.substr(offsets[index], lengths[index]);
+}
+
+Expected<TokenBuffer> TryTokenize(std::string_view source) {
+    if (source.size() > std::numeric_limits<uint32_t>::max()) {
+        return ParseError{"input too large"};
+    }
+    TokenBuffer tokens;
+    tokens.source = source;
+    // Tokens of typical code average a few bytes including separators.
+    size_t expected = source.size() / 4 + 1;
+    tokens.kinds.reserve(expected);
+    tokens.offsets.reserve(expected);
+    tokens.lengths.reserve(expected);
+    tokens.values.reserve(expected);
+
+    // Indexed by state - EMIT_SYMBOL.
+    static constexpr TokenKind kEmitKinds[] = {TokenKind::SYMBOL, TokenKind::CONSTANT,
+                                               TokenKind::OPEN,   TokenKind::CLOSE,
+                                               TokenKind::QUOTE,  TokenKind::DOT};
+    const char* pos = source.data();
+    const char* end = pos + source.size();
+    while (true) {
+        const char* begin;
+        LexState state = LexBuffer(START, &pos, end, &begin);
+        if (state == EMIT_END) {
+            break;
+        }
+        if (state == LEX_ERROR) {
+            return ParseError{"syntax error"};
+        }
+        std::string_view text(begin, pos - begin);
+        int64_t value = 0;
+        if (state == EMIT_NUMBER && !ParseConstant(text, &value)) {
+            return ParseError{kLiteralOutOfRange};
+        }
+        tokens.kinds.push_back(kEmitKinds[state - EMIT_SYMBOL]);
+        tokens.offsets.push_back(begin - source.data());
+        tokens.lengths.push_back(text.size());
+        tokens.values.push_back(value);
+    }
+    return tokens;
+}
+
+size_t FindTokenEnd(std::string_view source, size_t pos) {
+    const char* cur = source.data() + pos;
+    const char* begin;
+    if (LexBuffer(START, &cur, source.data() + source.size(), &begin) == LEX_ERROR) {
+        return pos + 1;
+    }
+    return cur - source.data();
+}
+
+TokenBuffer Tokenize(std::string_view source) {
+    return TryTokenize(source).ValueOrThrow();
+}
+
+void ChunkedTokenizer::Feed(std::string_view chunk) {
+    if (finished_) {
+        throw SyntaxError("input after end of stream");
+    }
+    // Whatever is left of the previous chunk is a token prefix, already saved in lexeme_.
+    pos_ = chunk.data();
+    end_ = pos_ + chunk.size();
+}
+
+void ChunkedTokenizer::Finish() {
+    finished_ = true;
+}
+
+bool ChunkedTokenizer::IsEnd() const {
+    return at_end_;
+}
+
+bool ChunkedTokenizer::Poll(Token* token) {
+    if (at_end_) {
+        return false;
+    }
+    // A token emitted from lexeme_ stays valid until this call, so drop it only now.
+    if (state_ == START) {
+        lexeme_.clear();
+    }
+    const char* begin;
+    auto state = LexBuffer(static_cast<LexState>(state_), &pos_, end_, &begin, finished_);
+    if (state < RUNNING_STATE_COUNT) {
+        // The chunk ended inside a token: keep its prefix and where the DFA stopped.
+        lexeme_.append(begin, pos_);
+        state_ = state;
+        return false;
+    }
+    state_ = START;
+    if (state == EMIT_END) {
+        at_end_ = true;
+        return false;
+    }
+    std::string_view text(begin, pos_ - begin);
+    if (!lexeme_.empty()) {
+        lexeme_.append(text);
+        text = lexeme_;
+    }
+    *token = MakeToken(state, text);
+    return true;
+}
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <variant>
+#include <vector>
 #include <optional>
 #include <istream>
+#include <string>
+#include <string_view>
 
+#include "error.h"
+
+// In buffer mode `name` points into the source, in stream mode into the tokenizer's own
+// storage; either way it is only valid until the next call to Tokenizer::Next().
 struct SymbolToken {
-    std::string name;
+    std::string_view name;
 
     bool operator==(const SymbolToken& other) const;
 };
@@ -32,6 +40,12 @@ class Tokenizer {
 public:
     Tokenizer(std::istream* in);
 
+    // Tokenizes memory that is already in place, without copying it into a stream.
+    // The source must outlive the tokenizer.
+    Tokenizer(std::string_view source);
+
+    Tokenizer(const char* data, size_t size);
+
     bool IsEnd();
 
     void Next();
@@ -45,9 +59,69 @@ public:
     bool IsSymbol(const char& elem);
 
 private:
-    std::istream* in_;
-    std::string cur_const_;
-    std::string cur_symbol_;
-    int cur_char_;
+    std::istream* in_ = nullptr;
+    const char* pos_ = nullptr;
+    const char* end_ = nullptr;
+    // Text of the current token in stream mode, where there is no buffer to point into.
+    std::string lexeme_;
+    bool at_end_ = false;
     Token token_;
-};
\ No newline at end of file
+};
+
+enum class TokenKind : uint8_t { CONSTANT, OPEN, CLOSE, SYMBOL, QUOTE, DOT };
+
+// Every token of an input, laid out as parallel arrays indexed by token number.
+struct TokenBuffer {
+    std::string_view source;
+    std::vector<TokenKind> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    // Decoded value for CONSTANT tokens, 0 for the rest.
+    std::vector<int64_t> values;
+
+    size_t Size() const;
+
+    std::string_view Text(size_t index) const;
+};
+
+// Tokenizes the whole source in one pass. The buffer points into `source`, which must outlive it.
+TokenBuffer Tokenize(std::string_view source);
+
+// Same as Tokenize(), but reports malformed input as a value instead of throwing SyntaxError.
+Expected<TokenBuffer> TryTokenize(std::string_view source);
+
+// End of the token that starts at `pos`, which must not be whitespace. A byte that starts no
+// token is taken as one on its own, left for the tokenizer to reject when the input is read.
+size_t FindTokenEnd(std::string_view source, size_t pos);
+
+// Push-style tokenizer for input that arrives in pieces, e.g. pipe or socket reads. Tokens may
+// span chunks; each one is handed out as soon as its last byte has been fed.
+//
+//     tokenizer.Feed(chunk);
+//     while (tokenizer.Poll(&token)) { ... }
+//
+// A SymbolToken returned by Poll() is valid until the next Feed() or Poll().
+class ChunkedTokenizer {
+public:
+    // The chunk must stay alive until Poll() returns false for it.
+    void Feed(std::string_view chunk);
+
+    // No more input: a token cut off by the end of the last chunk is completed.
+    void Finish();
+
+    // Stores the next complete token and returns true, or returns false if more input is needed
+    // (or the input is over).
+    bool Poll(Token* token);
+
+    // True once Finish() was called and every token has been returned.
+    bool IsEnd() const;
+
+private:
+    const char* pos_ = nullptr;
+    const char* end_ = nullptr;
+    // Lexer state saved at a chunk boundary, and the token prefix read so far.
+    uint8_t state_ = 0;
+    std::string lexeme_;
+    bool finished_ = false;
+    bool at_end_ = false;
+};
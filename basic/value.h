@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+
+#include "symbol_table.h"
+
+class Object;
+class Number;
+
+// One machine word holding an evaluation result. Fixnums, #t, #f, () and interned symbols are
+// stored in the word itself; everything else points at an Object. Arithmetic and predicates on
+// values never allocate.
+//
+// Layout, by the low bits:
+//     ...1  fixnum, the upper 63 bits are the signed integer
+//     .000  Object*, borrowed (null for no value)
+//     .010  const InternedSymbol*
+//     .100  immediate: #f, #t or () in the bits above the tag
+//     .110  const Number*, borrowed, for integers that do not fit a fixnum
+//
+// A value does not own what it points to; whoever produced it keeps the object alive (the tree
+// being evaluated, or the interpreter for the duration of a Run()). Conversions from and to
+// objects, which need the complete types, are defined in object.h.
+class Value {
+public:
+    constexpr Value() = default;
+
+    static constexpr int64_t kMinFixnum = INT64_MIN / 2;
+    static constexpr int64_t kMaxFixnum = INT64_MAX / 2;
+
+    static constexpr bool FitsFixnum(int64_t value) {
+        return value >= kMinFixnum && value <= kMaxFixnum;
+    }
+
+    // `value` must fit a fixnum.
+    static constexpr Value Fixnum(int64_t value) {
+        return Value{(static_cast<uintptr_t>(value) << 1) | 1};
+    }
+
+    static constexpr Value Bool(bool value) {
+        return Immediate(value ? kTrue : kFalse);
+    }
+
+    static constexpr Value Nil() {
+        return Immediate(kNil);
+    }
+
+    static Value Symbol(const InternedSymbol* symbol) {
+        return Value{reinterpret_cast<uintptr_t>(symbol) | kSymbolTag};
+    }
+
+    static Value Heap(Object* object) {
+        return Value{reinterpret_cast<uintptr_t>(object)};
+    }
+
+    static Value Boxed(const Number* number) {
+        return Value{reinterpret_cast<uintptr_t>(number) | kBoxedTag};
+    }
+
+    constexpr bool IsFixnum() const {
+        return bits_ & 1;
+    }
+
+    constexpr bool IsBool() const {
+        return bits_ == Bool(true).bits_ || bits_ == Bool(false).bits_;
+    }
+
+    constexpr bool IsTrue() const {
+        return bits_ == Bool(true).bits_;
+    }
+
+    constexpr bool IsFalse() const {
+        return bits_ == Bool(false).bits_;
+    }
+
+    constexpr bool IsNil() const {
+        return bits_ == Nil().bits_;
+    }
+
+    constexpr bool IsSymbol() const {
+        return (bits_ & kTagMask) == kSymbolTag;
+    }
+
+    constexpr bool IsBoxed() const {
+        return (bits_ & kTagMask) == kBoxedTag;
+    }
+
+    constexpr bool IsHeap() const {
+        return (bits_ & kTagMask) == kHeapTag && bits_;
+    }
+
+    constexpr bool IsNull() const {
+        return !bits_;
+    }
+
+    constexpr bool IsNumber() const {
+        return IsFixnum() || IsBoxed();
+    }
+
+    constexpr int64_t GetFixnum() const {
+        return static_cast<int64_t>(bits_) >> 1;
+    }
+
+    // Fixnum or boxed.
+    int64_t GetNumber() const;
+
+    const InternedSymbol* GetSymbol() const {
+        return reinterpret_cast<const InternedSymbol*>(bits_ & ~kTagMask);
+    }
+
+    Object* GetHeap() const {
+        return reinterpret_cast<Object*>(bits_);
+    }
+
+    const Number* GetBoxed() const {
+        return reinterpret_cast<const Number*>(bits_ & ~kTagMask);
+    }
+
+    // Identity: equal immediates and fixnums, or the same symbol or object.
+    constexpr bool operator==(const Value& other) const {
+        return bits_ == other.bits_;
+    }
+
+private:
+    static constexpr uintptr_t kTagMask = 7;
+    static constexpr uintptr_t kHeapTag = 0;
+    static constexpr uintptr_t kSymbolTag = 2;
+    static constexpr uintptr_t kImmediateTag = 4;
+    static constexpr uintptr_t kBoxedTag = 6;
+
+    enum ImmediateKind : uintptr_t { kFalse, kTrue, kNil };
+
+    constexpr explicit Value(uintptr_t bits) : bits_(bits) {
+    }
+
+    static constexpr Value Immediate(ImmediateKind kind) {
+        return Value{(kind << 3) | kImmediateTag};
+    }
+
+    uintptr_t bits_ = 0;
+};
+
+static_assert(sizeof(Value) == sizeof(void*));
+static_assert(sizeof(uintptr_t) == 8, "fixnums need 64-bit words");
+static_assert(alignof(InternedSymbol) >= 8);